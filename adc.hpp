@@ -12,10 +12,32 @@
 *
 *          dr ADC_result r resultat avlst frn AD-omvandlaren OCH ADC_MAX
 *          utgr hgsta mjliga avlsta vrde, vilket r 1023.0.
+*
+*          Frutom blockerande avlsning via read kan AD-omvandling ske
+*          asynkront via avbrott (ADC_vect). Resultaten placeras d i en
+*          ringbuffert, som lses av frn huvudprogrammet, medan processorn
+*          kan utfra annat arbete under pgende AD-omvandlingar.
+*
+*          AD-omvandling kan ocks ske i vilolget ADC Noise Reduction, dr
+*          processorns klocka samt I/O-klockan stngs av under omvandlingen.
+*          Drmed minskar det digitala bruset i resultatet samtidigt som
+*          energifrbrukningen per AD-omvandling sjunker.
+*
+*          Fr sluten styrning av en PWM-utsignal frn en analog insignal,
+*          dr AD-omvandlingen startas av timerkretsen, se adc_pwm.hpp.
 ********************************************************************************/
 #ifndef ADC_HPP_
 #define ADC_HPP_
 
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "ring_buffer.hpp"
+#include "fixed.hpp"
+#include "pin_map.hpp"
+#include "adc_scan.hpp"
+#include "adc_pwm.hpp"
+#include <avr/sleep.h>
+
 /********************************************************************************
 * adc: Klass fr implementering av AD-omvandlare, som mjliggr avlsning
 *      av insignaler frn analoga pinnar, berkning av on- och off-tid fr
@@ -28,6 +50,38 @@ private:
    uint16_t pwm_on_us_ = 0;                 /* On-tid fr PWM-generering i mikrosekunder. */
    uint16_t pwm_off_us_ = 0;                /* Off-tid fr PWM-generering i mikrosekunder. */
    static constexpr auto ADC_MAX_ = 1023.0; /* Hgsta digitala vrde vid AD-omvandling. */
+
+   /********************************************************************************
+   * get_duty_cycle: Returnerar duty cycle fr angivet AD-omvandlat vrde som
+   *                 ett fixpunktstal i formatet Q16.16, dvs.
+   *                 round(result * 65536 / 1023). Eftersom 65536 / 1023 =
+   *                 64 + 64 / 1023 berknas detta via multiplikation med 64
+   *                 plus result / 16, vilket ger exakt avrundat resultat
+   *                 fr samtliga vrden 0 - 1023 utan division.
+   *
+   *                 - result: AD-omvandlat vrde mellan 0 - 1023.
+   ********************************************************************************/
+   static constexpr q16_16 get_duty_cycle(const uint16_t result)
+   {
+      return q16_16::from_raw(static_cast<int32_t>(result) * 64 + ((result + 8) >> 4));
+   }
+
+   static inline ring_buffer<uint16_t, 16> results_; /* Resultat frn asynkrona AD-omvandlingar. */
+   static inline volatile uint16_t overruns_ = 0;     /* Antal resultat som kastats vid full buffert. */
+   static inline volatile bool sleep_pending_ = false; /* Indikerar pgende AD-omvandling i vilolge. */
+
+   /* Prescaler 128 fr AD-omvandlarens klocka (125 kHz vid 16 MHz): */
+   static constexpr uint8_t PRESCALER_ = (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+
+   /********************************************************************************
+   * busy: Indikerar ifall AD-omvandlaren anvnds av timerstyrd avlsning via
+   *       klassen adc_scan eller av sluten styrning via klassen adc_pwm.
+   *       Resultaten skickas d till respektive klass i avbrottsrutinen.
+   ********************************************************************************/
+   static bool busy(void)
+   {
+      return adc_scan::active() || adc_pwm::active();
+   }
 public:
 
    /********************************************************************************
@@ -43,9 +97,9 @@ public:
       {
          this->pin_ = pin;
       }
-      else if (pin >= 14 && pin <= 19)
+      else if (pin_map::port(pin) == io_port::c)
       {
-         this->pin_ = pin - 14;
+         this->pin_ = pin_map::bit(pin);
       }
       
       static_cast<void>(this->read());
@@ -86,10 +140,13 @@ public:
 
    /********************************************************************************
    * read: Lser av en analog insignal och returnerar motsvarande digitala
-   *       motsvarighet mellan 0 - 1023.
+   *       motsvarighet mellan 0 - 1023. Ifall AD-omvandlaren anvnds av
+   *       klassen adc_scan eller adc_pwm sker ingen avlsning, eftersom
+   *       dessa annars skulle avbrytas, och 0 returneras.
    ********************************************************************************/
    uint16_t read(void) const
    {
+      if (busy()) return 0;
       ADMUX = (1 << REFS0) | this->pin_;
       ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
       while ((ADCSRA & (1 << ADIF)) == 0);
@@ -97,6 +154,32 @@ public:
       return ADC;
    }
 
+   /********************************************************************************
+   * read_oversampled: Lser av en analog insignal med frhjd upplsning via
+   *                   versampling. Fr varje extra bit summeras fyra gnger
+   *                   s mnga AD-omvandlingar, varefter summan skiftas ned
+   *                   en bit per extra bit (decimering). Resultatet ligger
+   *                   drmed mellan 0 - (1024 << extra_bits) - 1. Brus p
+   *                   insignalen (minst 1 LSB) krvs fr att de extra
+   *                   bitarna ska bli meningsfulla.
+   *
+   *                   - extra_bits: Antalet extra bitar (0 - 6), vilket
+   *                                 krver 4^extra_bits AD-omvandlingar.
+   ********************************************************************************/
+   uint16_t read_oversampled(const uint8_t extra_bits) const
+   {
+      const uint8_t bits = extra_bits > 6 ? 6 : extra_bits;
+      const uint16_t num_samples = 1 << (2 * bits);
+      uint32_t sum = 0;
+
+      for (uint16_t i = 0; i < num_samples; ++i)
+      {
+         sum += this->read();
+      }
+
+      return static_cast<uint16_t>(sum >> bits);
+   }
+
    /********************************************************************************
    * duty_cycle: Lser av en analog insignal och returnerar motsvarande duty cycle
    *             som ett flyttal mellan 0 - 1.
@@ -106,20 +189,206 @@ public:
       return this->read() / this->ADC_MAX_;
    }
 
+   /********************************************************************************
+   * duty_cycle_fixed: Lser av en analog insignal och returnerar motsvarande
+   *                   duty cycle som ett fixpunktstal mellan 0 - 1 i formatet
+   *                   Q16.16, berknat enbart med heltal.
+   ********************************************************************************/
+   q16_16 duty_cycle_fixed(void) const
+   {
+      return this->get_duty_cycle(this->read());
+   }
+
    /********************************************************************************
    * get_pwm_values: Lser av en analog insignal och berknar on- och off-tid fr
    *                 fr PWM-generering, avrundat till nrmaste heltal.
+   *                 Berkningen sker i fixpunktsformat, vilket ger samma
+   *                 resultat som motsvarande flyttalsberkning med hgst en
+   *                 mikrosekunds avvikelse.
    *
    *                 - pwm_period_us: PWM-perioden (on-tid + off-tid) mtt i
    *                                  mikrosekunder (default = 10 000 us).
    ********************************************************************************/
    void get_pwm_values(const uint16_t pwm_period_us = 10000)
    {
-      this->pwm_on_us_ = static_cast<uint16_t>(this->duty_cycle() * pwm_period_us + 0.5);
+      const uint32_t duty_cycle = static_cast<uint32_t>(this->duty_cycle_fixed().raw());
+      this->pwm_on_us_ = static_cast<uint16_t>((duty_cycle * pwm_period_us + 0x8000) >> 16);
       this->pwm_off_us_ = pwm_period_us - this->pwm_on_us_;
       return;
    }
 
+   /********************************************************************************
+   * start_async: Startar asynkron AD-omvandling av angiven analog pin. Nr
+   *              AD-omvandlingen r slutfrd placeras resultatet i ring-
+   *              bufferten via avbrottsrutinen fr ADC_vect. I free running-
+   *              lge startas nsta AD-omvandling direkt av hrdvaran, vilket
+   *              ger AD-omvandlarens fulla samplingshastighet (cirka 9600
+   *              AD-omvandlingar per sekund), tills stop_async anropas.
+   *
+   *              En blockerande avlsning via read avbryter asynkron
+   *              AD-omvandling. Vid lyckad start returneras 0. Ifall
+   *              AD-omvandlaren anvnds av klassen adc_scan eller adc_pwm
+   *              returneras felkod 1.
+   *
+   *              - free_running: Indikerar ifall AD-omvandling ska ske
+   *                              kontinuerligt (default = false, dvs. en
+   *                              enstaka AD-omvandling).
+   ********************************************************************************/
+   int start_async(const bool free_running = false) const
+   {
+      if (busy()) return 1;
+      ADMUX = (1 << REFS0) | this->pin_;
+      ADCSRB = 0;
+
+      if (free_running)
+      {
+         ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIF) | (1 << ADIE) | PRESCALER_;
+      }
+      else
+      {
+         ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADIF) | (1 << ADIE) | PRESCALER_;
+      }
+
+      asm("SEI");
+      return 0;
+   }
+
+   /********************************************************************************
+   * stop_async: Avslutar asynkron AD-omvandling. Redan lagrade resultat
+   *             ligger kvar i ringbufferten.
+   ********************************************************************************/
+   static void stop_async(void)
+   {
+      ADCSRA &= ~((1 << ADATE) | (1 << ADIE));
+      return;
+   }
+
+   /********************************************************************************
+   * available: Returnerar antalet resultat som vntar p att lsas av.
+   ********************************************************************************/
+   static uint8_t available(void)
+   {
+      return results_.size();
+   }
+
+   /********************************************************************************
+   * get_result: Hmtar det ldsta resultatet frn asynkron AD-omvandling.
+   *             Ifall ett resultat fanns returneras 0, annars felkod 1.
+   *
+   *             - result: Referens till variabel dr resultatet lagras.
+   ********************************************************************************/
+   static int get_result(uint16_t& result)
+   {
+      return results_.pop(result);
+   }
+
+   /********************************************************************************
+   * overruns: Returnerar antalet resultat som har kastats eftersom ring-
+   *           bufferten var full. Ett vrde ver noll indikerar att
+   *           resultaten inte lses av tillrckligt ofta.
+   ********************************************************************************/
+   static uint16_t overruns(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t overruns = overruns_;
+      SREG = sreg;
+      return overruns;
+   }
+
+   /********************************************************************************
+   * read_noise_reduced: Lser av en analog insignal i vilolge och returnerar
+   *                     motsvarande digitala motsvarighet mellan 0 - 1023.
+   *                     Processorn frstts i vilolget ADC Noise Reduction,
+   *                     vilket startar AD-omvandlingen, och vcks av avbrottet
+   *                     nr AD-omvandlingen r slutfrd. Vcks processorn
+   *                     tidigare av ett annat avbrott tergr den till
+   *                     vilolget tills AD-omvandlingen r klar.
+   *
+   *                     I vilolget ADC Noise Reduction stannar Timer 0 - 2,
+   *                     eftersom I/O-klockan stngs av. Ifall timergenererat
+   *                     avbrott r aktiverat p ngon timerkrets anvnds drfr
+   *                     i stllet vilolget Idle, s att timerkretsarna inte
+   *                     tappar tid. Processorn vilar d fortfarande under
+   *                     AD-omvandlingen, men I/O-klockan r aktiv. Observera
+   *                     att den delade ticken (compare match A p Timer 2)
+   *                     rknas som ett aktiverat avbrott, eftersom den annars
+   *                     skulle tappa tid. S lnge ngon mjukvarutimer eller
+   *                     den delade ticken anvnds sker avlsningen drmed
+   *                     alltid i vilolget Idle.
+   *
+   *                     Vid lyckad avlsning returneras 0. Ifall AD-omvandlaren
+   *                     anvnds av klassen adc_scan eller adc_pwm returneras
+   *                     felkod 1, eftersom resultatet d skulle hanteras av
+   *                     fel avbrottsrutin. Avbrottsstatus terstlls innan
+   *                     funktionen returnerar.
+   *
+   *                     - result: Referens till variabel dr resultatet lagras.
+   ********************************************************************************/
+   int read_noise_reduced(uint16_t& result) const
+   {
+      const bool timers_armed = (TIMSK0 | TIMSK1 | TIMSK2) != 0;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (busy())
+      {
+         SREG = sreg;
+         return 1;
+      }
+
+      ADMUX = (1 << REFS0) | this->pin_;
+      ADCSRA = (1 << ADEN) | (1 << ADIF) | (1 << ADIE) | PRESCALER_;
+      sleep_pending_ = true;
+
+      if (timers_armed)
+      {
+         set_sleep_mode(SLEEP_MODE_IDLE);
+         ADCSRA |= (1 << ADSC);
+      }
+      else
+      {
+         set_sleep_mode(SLEEP_MODE_ADC);
+      }
+
+      while (sleep_pending_)
+      {
+         sleep_enable();
+         asm("SEI");
+         sleep_cpu();
+         sleep_disable();
+         asm("CLI");
+      }
+
+      ADCSRA &= ~(1 << ADIE);
+      result = ADC;
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * on_conversion_complete: Lagrar resultatet frn slutfrd AD-omvandling i
+   *                         ringbufferten. Vid AD-omvandling i vilolge lmnas
+   *                         resultatet i stllet kvar i dataregistret, dr det
+   *                         lses av efter att processorn har vckts. Ska
+   *                         anropas frn avbrottsrutinen fr ADC_vect.
+   ********************************************************************************/
+   static void on_conversion_complete(void)
+   {
+      if (sleep_pending_)
+      {
+         sleep_pending_ = false;
+         return;
+      }
+
+      const uint16_t result = ADC;
+      if (results_.push(result))
+      {
+         overruns_++;
+      }
+      return;
+   }
+
 };
 
 #endif /* ADC_HPP_ */
\ No newline at end of file
@@ -0,0 +1,267 @@
+/********************************************************************************
+* adc_filter.hpp: Innehller filter fr AD-omvandlade vrden, implementerade
+*                 med heltalsaritmetik (fixed point) s att inga flyttal
+*                 behver anvndas. Varje filter matas antingen med frdiga
+*                 AD-omvandlade vrden via update eller direkt frn ett
+*                 adc-objekt via read.
+*
+*                 Tillgngliga filter:
+*
+*                 moving_average    : Glidande medelvrde ver N vrden.
+*                 exponential_filter: Exponentiellt (IIR) lgpassfilter.
+*                 median_filter     : Median av de N senaste vrdena, vilket
+*                                     tar bort enstaka spikar helt.
+*
+*                 Frhjd upplsning via versampling erhlls via metoden
+*                 read_oversampled i klassen adc.
+********************************************************************************/
+#ifndef ADC_FILTER_HPP_
+#define ADC_FILTER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "adc.hpp"
+
+/********************************************************************************
+* moving_average: Klass fr glidande medelvrde ver de N senaste vrdena.
+*                 N mste utgras av en tvpotens mellan 2 - 64, s att
+*                 divisionen kan ersttas med ett skift. Summan uppdateras
+*                 lpande, vilket gr att varje uppdatering endast krver en
+*                 addition och en subtraktion oavsett N.
+********************************************************************************/
+template<uint8_t N>
+class moving_average
+{
+   static_assert(N >= 2 && N <= 64 && (N & (N - 1)) == 0,
+                 "Antalet vrden mste vara en tvpotens mellan 2 - 64!");
+private:
+   uint16_t samples_[N] = { }; /* De N senaste vrdena. */
+   uint32_t sum_ = 0;          /* Summan av lagrade vrden. */
+   uint8_t index_ = 0;         /* Index dr nsta vrde ska skrivas. */
+
+   /********************************************************************************
+   * shift: Returnerar antalet skift som motsvarar division med N.
+   ********************************************************************************/
+   static constexpr uint8_t shift(void)
+   {
+      uint8_t shift = 0;
+      while ((1 << shift) < N) shift++;
+      return shift;
+   }
+
+public:
+
+   /********************************************************************************
+   * moving_average: Initierar nytt filter med samtliga vrden satta till noll.
+   ********************************************************************************/
+   moving_average(void) { }
+
+   /********************************************************************************
+   * update: Lgger till ett nytt vrde och returnerar aktuellt medelvrde,
+   *         avrundat till nrmaste heltal.
+   *
+   *         - sample: Det nya vrdet.
+   ********************************************************************************/
+   uint16_t update(const uint16_t sample)
+   {
+      this->sum_ -= this->samples_[this->index_];
+      this->sum_ += sample;
+      this->samples_[this->index_] = sample;
+      this->index_ = (this->index_ + 1) & (N - 1);
+      return this->value();
+   }
+
+   /********************************************************************************
+   * read: Lser av ett nytt vrde frn angiven AD-omvandlare och returnerar
+   *       aktuellt medelvrde.
+   *
+   *       - adc: Referens till AD-omvandlaren som ska lsas av.
+   ********************************************************************************/
+   uint16_t read(const adc& adc)
+   {
+      return this->update(adc.read());
+   }
+
+   /********************************************************************************
+   * value: Returnerar aktuellt medelvrde utan att lgga till ngot vrde.
+   ********************************************************************************/
+   uint16_t value(void) const
+   {
+      return static_cast<uint16_t>((this->sum_ + (N / 2)) >> shift());
+   }
+
+   /********************************************************************************
+   * fill: Stter samtliga lagrade vrden till angivet vrde, exempelvis
+   *       frsta avlsta vrde, s att filtret inte startar frn noll.
+   *
+   *       - sample: Vrdet som samtliga element ska sttas till.
+   ********************************************************************************/
+   void fill(const uint16_t sample)
+   {
+      for (auto& i : this->samples_)
+      {
+         i = sample;
+      }
+
+      this->sum_ = static_cast<uint32_t>(sample) * N;
+      return;
+   }
+};
+
+/********************************************************************************
+* exponential_filter: Klass fr exponentiellt lgpassfilter (frsta ordningens
+*                     IIR-filter) enligt nedan:
+*
+*                        y[n] = y[n - 1] + (x[n] - y[n - 1]) / 2^k,
+*
+*                     dr k anger filtrets trghet. Tillstndet lagras med
+*                     tta brkbitar (Q.8), s att sm frndringar inte
+*                     frsvinner vid skiftet.
+********************************************************************************/
+class exponential_filter
+{
+private:
+   int32_t state_ = 0;         /* Filtrets tillstnd med tta brkbitar. */
+   uint8_t k_ = 3;             /* Filterkonstant, division med 2^k. */
+   bool initialized_ = false;  /* Indikerar ifall frsta vrdet har lagts till. */
+   static constexpr uint8_t FRACTION_BITS_ = 8; /* Antal brkbitar i tillstndet. */
+
+public:
+
+   /********************************************************************************
+   * exponential_filter: Initierar nytt filter med angiven filterkonstant.
+   *
+   *                     - k: Filterkonstant mellan 1 - 8 (default = 3), dr ett
+   *                          hgre vrde ger ett trgare filter.
+   ********************************************************************************/
+   exponential_filter(const uint8_t k = 3)
+   {
+      this->k_ = k < 1 ? 1 : (k > 8 ? 8 : k);
+      return;
+   }
+
+   /********************************************************************************
+   * update: Lgger till ett nytt vrde och returnerar filtrerat vrde,
+   *         avrundat till nrmaste heltal. Frsta vrdet anvnds som
+   *         startvrde fr filtret.
+   *
+   *         - sample: Det nya vrdet.
+   ********************************************************************************/
+   uint16_t update(const uint16_t sample)
+   {
+      const int32_t input = static_cast<int32_t>(sample) << FRACTION_BITS_;
+
+      if (!this->initialized_)
+      {
+         this->state_ = input;
+         this->initialized_ = true;
+      }
+      else
+      {
+         this->state_ += (input - this->state_) >> this->k_;
+      }
+
+      return this->value();
+   }
+
+   /********************************************************************************
+   * read: Lser av ett nytt vrde frn angiven AD-omvandlare och returnerar
+   *       filtrerat vrde.
+   *
+   *       - adc: Referens till AD-omvandlaren som ska lsas av.
+   ********************************************************************************/
+   uint16_t read(const adc& adc)
+   {
+      return this->update(adc.read());
+   }
+
+   /********************************************************************************
+   * value: Returnerar aktuellt filtrerat vrde, avrundat till nrmaste heltal.
+   ********************************************************************************/
+   uint16_t value(void) const
+   {
+      return static_cast<uint16_t>((this->state_ + (1 << (FRACTION_BITS_ - 1))) >> FRACTION_BITS_);
+   }
+
+   /********************************************************************************
+   * reset: terstller filtret, s att nsta vrde anvnds som startvrde.
+   ********************************************************************************/
+   void reset(void)
+   {
+      this->state_ = 0;
+      this->initialized_ = false;
+      return;
+   }
+};
+
+/********************************************************************************
+* median_filter: Klass fr medianfilter ver de N senaste vrdena, dr N
+*                mste vara ett udda tal mellan 3 - 9. Vid varje uppdatering
+*                sorteras en kopia av vrdena via insttningssortering,
+*                vilket r snabbt fr s f element.
+********************************************************************************/
+template<uint8_t N>
+class median_filter
+{
+   static_assert(N >= 3 && N <= 9 && (N & 1), "Antalet vrden mste vara udda mellan 3 - 9!");
+private:
+   uint16_t samples_[N] = { }; /* De N senaste vrdena. */
+   uint8_t index_ = 0;         /* Index dr nsta vrde ska skrivas. */
+
+public:
+
+   /********************************************************************************
+   * median_filter: Initierar nytt filter med samtliga vrden satta till noll.
+   ********************************************************************************/
+   median_filter(void) { }
+
+   /********************************************************************************
+   * update: Lgger till ett nytt vrde och returnerar medianen av de N
+   *         senaste vrdena.
+   *
+   *         - sample: Det nya vrdet.
+   ********************************************************************************/
+   uint16_t update(const uint16_t sample)
+   {
+      this->samples_[this->index_] = sample;
+      if (++this->index_ >= N) this->index_ = 0;
+      return this->value();
+   }
+
+   /********************************************************************************
+   * read: Lser av ett nytt vrde frn angiven AD-omvandlare och returnerar
+   *       medianen av de N senaste vrdena.
+   *
+   *       - adc: Referens till AD-omvandlaren som ska lsas av.
+   ********************************************************************************/
+   uint16_t read(const adc& adc)
+   {
+      return this->update(adc.read());
+   }
+
+   /********************************************************************************
+   * value: Returnerar medianen av lagrade vrden.
+   ********************************************************************************/
+   uint16_t value(void) const
+   {
+      uint16_t sorted[N];
+
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         const uint16_t sample = this->samples_[i];
+         uint8_t j = i;
+
+         while (j > 0 && sorted[j - 1] > sample)
+         {
+            sorted[j] = sorted[j - 1];
+            j--;
+         }
+
+         sorted[j] = sample;
+      }
+
+      return sorted[N / 2];
+   }
+};
+
+#endif /* ADC_FILTER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,335 @@
+/********************************************************************************
+* adc_pwm.hpp: Innehller funktionalitet fr sluten styrning frn en analog
+*              insignal till en hrdvarugenererad PWM-utsignal via klassen
+*              adc_pwm, exempelvis fr styrning av en lysdiods ljusstyrka
+*              via en potentiometer.
+*
+*              Timerkretsen krs i Fast PWM Mode, dr utsignalen p
+*              timerkretsens OC-pin genereras direkt av hrdvaran. Vid varje
+*              overflow startas en AD-omvandling automatiskt (auto trigger),
+*              varefter avbrottsrutinen fr ADC_vect omvandlar resultatet
+*              till ett nytt compare-vrde via valfri kurva samt skalning.
+*              Det nya compare-vrdet laddas av hrdvaran vid nsta PWM-
+*              period. Drmed sker styrningen med fast takt utan jitter och
+*              utan att huvudprogrammet r inblandat.
+*
+*              Timerkretsen reserveras via klassen timer och kan drmed inte
+*              anvndas av ngot timer-objekt samtidigt. AD-omvandlaren
+*              anvnds exklusivt under pgende styrning, varfr klassen
+*              adc_scan samt avlsningar via klassen adc avvisas s lnge
+*              styrningen pgr.
+*
+*              Utsignal     Pin (Arduino Uno)     Upplsning     Takt
+*               oc0a         6 (PORTD6)             8 bitar      7.8 kHz
+*               oc0b         5 (PORTD5)             8 bitar      7.8 kHz
+*               oc1a         9 (PORTB1)            10 bitar      1.95 kHz
+*               oc1b        10 (PORTB2)            10 bitar      1.95 kHz
+*
+*              En AD-omvandling tar cirka 0.108 ms, vilket ryms inom den
+*              kortaste PWM-perioden om 0.128 ms.
+********************************************************************************/
+#ifndef ADC_PWM_HPP_
+#define ADC_PWM_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+
+/********************************************************************************
+* adc_pwm: Klass fr timerstyrd AD-omvandling med direkt uppdatering av en
+*          hrdvarugenererad PWM-utsignal. Endast en styrning kan vara
+*          aktiv t gngen, eftersom AD-omvandlaren delas.
+********************************************************************************/
+class adc_pwm
+{
+public:
+   enum class output; /* Frdeklaration av enumerationsklass fr utsignal. */
+   typedef uint16_t (*curve)(const uint16_t reading); /* Kurva, avbildar 0 - 1023 p 0 - 1023. */
+
+private:
+   basic_timer<uint8_t> circuit_;  /* Reservation av timerkretsen. */
+   output output_;                 /* Anvnd utsignal. */
+   uint8_t channel_ = 0;           /* Analog kanal (0 - 5). */
+   curve curve_ = nullptr;         /* Kurva som tillmpas p avlst vrde. */
+   uint16_t low_ = 0;              /* Utsignalens lgsta vrde (0 - 1023). */
+   uint16_t span_ = 1024;          /* Utsignalens omfng, hgsta - lgsta vrde + 1. */
+   volatile uint16_t reading_ = 0; /* Senast avlst vrde. */
+   volatile uint16_t value_ = 0;   /* Senast berknat utvrde (0 - 1023). */
+   volatile uint32_t samples_ = 0; /* Antal genomfrda AD-omvandlingar. */
+   static inline adc_pwm* instance_ = nullptr; /* Aktiv styrning. */
+
+   /* Prescaler 128 fr AD-omvandlarens klocka (125 kHz vid 16 MHz): */
+   static constexpr uint8_t PRESCALER_ = (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+
+   /********************************************************************************
+   * on_timer0: Indikerar ifall angiven utsignal tillhr Timer 0.
+   *
+   *            - out: Aktuell utsignal.
+   ********************************************************************************/
+   static constexpr bool on_timer0(const output out)
+   {
+      return out == output::oc0a || out == output::oc0b;
+   }
+
+   /********************************************************************************
+   * write_compare: Skriver angivet utvrde (0 - 1023) till compare-registret
+   *                fr anvnd utsignal. Timer 0 anvnder de tta mest
+   *                signifikanta bitarna.
+   *
+   *                - value: Utvrdet som ska skrivas.
+   ********************************************************************************/
+   void write_compare(const uint16_t value)
+   {
+      if (this->output_ == output::oc0a)
+      {
+         OCR0A = static_cast<uint8_t>(value >> 2);
+      }
+      else if (this->output_ == output::oc0b)
+      {
+         OCR0B = static_cast<uint8_t>(value >> 2);
+      }
+      else if (this->output_ == output::oc1a)
+      {
+         OCR1A = value;
+      }
+      else
+      {
+         OCR1B = value;
+      }
+
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * adc_pwm: Reserverar timerkretsen fr angiven utsignal. Ifall timer-
+   *          kretsen redan anvnds misslyckas efterfljande anrop av start.
+   *
+   *          - pin: Analog pin som ska lsas av, angiven som 0 - 5 eller
+   *                 A0 - A5 (14 - 19).
+   *          - out: Utsignalen som ska styras.
+   ********************************************************************************/
+   adc_pwm(const uint8_t pin,
+           const output out)
+      : circuit_(timer::reservable(on_timer0(out) ? timer::sel::timer0 : timer::sel::timer1), q16_16(0)),
+        output_(out)
+   {
+      this->channel_ = pin >= 14 ? pin - 14 : pin;
+      return;
+   }
+
+   /********************************************************************************
+   * ~adc_pwm: Stoppar styrningen och frigr timerkretsen.
+   ********************************************************************************/
+   ~adc_pwm(void)
+   {
+      this->stop();
+      return;
+   }
+
+   /* Styrningen ger en timerkrets och kan drmed inte kopieras: */
+   adc_pwm(const adc_pwm&) = delete;
+   adc_pwm& operator=(const adc_pwm&) = delete;
+
+   /********************************************************************************
+   * set_curve: Stter kurva som tillmpas p varje avlst vrde innan
+   *            skalning, exempelvis fr logaritmisk ljusstyrka. Kurvan
+   *            anropas frn avbrottsrutinen och ska drmed vara kort.
+   *
+   *            - new_curve: Ny kurva (nullptr = linjr).
+   ********************************************************************************/
+   void set_curve(const curve new_curve)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->curve_ = new_curve;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * set_range: Stter utsignalens omrde, s att avlst vrde 0 - 1023
+   *            avbildas linjrt p low - high. Vid lyckad instllning
+   *            returneras 0, annars felkod 1.
+   *
+   *            - low : Utsignalens lgsta vrde (0 - 1023).
+   *            - high: Utsignalens hgsta vrde (low - 1023).
+   ********************************************************************************/
+   int set_range(const uint16_t low,
+                 const uint16_t high)
+   {
+      if (high > 1023 || low > high) return 1;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->low_ = low;
+      this->span_ = high - low + 1;
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * start: Startar PWM-generering samt timerstyrd AD-omvandling. Vid lyckad
+   *        start returneras 0. Ifall timerkretsen inte kunde reserveras
+   *        eller AD-omvandlaren redan anvnds av en annan styrning eller
+   *        med automatisk start (via klassen adc_scan eller free running-
+   *        lge i klassen adc) returneras felkod 1.
+   ********************************************************************************/
+   int start(void)
+   {
+      if (this->channel_ > 5 || !this->circuit_.hardware()) return 1;
+      if (instance_ && instance_ != this) return 1;
+      if (!instance_ && (ADCSRA & (1 << ADATE))) return 1;
+
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->write_compare(0);
+
+      if (on_timer0(this->output_))
+      {
+         const uint8_t com = this->output_ == output::oc0a ? (1 << COM0A1) : (1 << COM0B1);
+         DDRD |= this->output_ == output::oc0a ? (1 << 6) : (1 << 5);
+         TCCR0A = com | (1 << WGM01) | (1 << WGM00);
+         TCCR0B = (1 << CS01);
+         TIFR0 = (1 << TOV0);
+         ADCSRB = (1 << ADTS2);
+      }
+      else
+      {
+         const uint8_t com = this->output_ == output::oc1a ? (1 << COM1A1) : (1 << COM1B1);
+         DDRB |= this->output_ == output::oc1a ? (1 << 1) : (1 << 2);
+         TCCR1A = com | (1 << WGM11) | (1 << WGM10);
+         TCCR1B = (1 << WGM12) | (1 << CS11);
+         TIFR1 = (1 << TOV1);
+         ADCSRB = (1 << ADTS2) | (1 << ADTS1);
+      }
+
+      instance_ = this;
+      ADMUX = (1 << REFS0) | this->channel_;
+      ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIF) | (1 << ADIE) | PRESCALER_;
+      SREG = sreg;
+      asm("SEI");
+      return 0;
+   }
+
+   /********************************************************************************
+   * stop: Stoppar timerstyrd AD-omvandling samt PWM-generering. Utsignalen
+   *       kopplas bort frn timerkretsen och stts lg.
+   ********************************************************************************/
+   void stop(void)
+   {
+      if (instance_ != this) return;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      ADCSRA &= ~((1 << ADATE) | (1 << ADIE));
+      ADCSRB = 0;
+
+      if (on_timer0(this->output_))
+      {
+         TCCR0A = 0;
+         PORTD &= this->output_ == output::oc0a ? ~(1 << 6) : ~(1 << 5);
+      }
+      else
+      {
+         TCCR1A = 0;
+         PORTB &= this->output_ == output::oc1a ? ~(1 << 1) : ~(1 << 2);
+      }
+
+      instance_ = nullptr;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * active: Indikerar ifall ngon styrning pgr.
+   ********************************************************************************/
+   static bool active(void)
+   {
+      return instance_ != nullptr;
+   }
+
+   /********************************************************************************
+   * reading: Returnerar senast avlst vrde mellan 0 - 1023.
+   ********************************************************************************/
+   uint16_t reading(void) const
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t reading = this->reading_;
+      SREG = sreg;
+      return reading;
+   }
+
+   /********************************************************************************
+   * value: Returnerar senast berknat utvrde mellan 0 - 1023, dvs. andelen
+   *        av PWM-perioden som utsignalen r hg, multiplicerat med 1023.
+   ********************************************************************************/
+   uint16_t value(void) const
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t value = this->value_;
+      SREG = sreg;
+      return value;
+   }
+
+   /********************************************************************************
+   * samples: Returnerar antalet genomfrda AD-omvandlingar sedan start.
+   ********************************************************************************/
+   uint32_t samples(void) const
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint32_t samples = this->samples_;
+      SREG = sreg;
+      return samples;
+   }
+
+   /********************************************************************************
+   * on_conversion_complete: Omvandlar resultatet frn slutfrd AD-omvandling
+   *                         till ett nytt compare-vrde via kurva samt
+   *                         skalning. Overflowflaggan nollstlls frst, s
+   *                         att nsta overflow ger en ny stigande flank ven
+   *                         ifall avbrottsrutinen frdrjs nra en hel PWM-
+   *                         period. Ska anropas frn avbrottsrutinen fr
+   *                         ADC_vect.
+   ********************************************************************************/
+   static void on_conversion_complete(void)
+   {
+      adc_pwm* self = instance_;
+      if (!self) return;
+
+      if (on_timer0(self->output_))
+      {
+         TIFR0 = (1 << TOV0);
+      }
+      else
+      {
+         TIFR1 = (1 << TOV1);
+      }
+
+      const uint16_t reading = ADC;
+      uint16_t input = self->curve_ ? self->curve_(reading) : reading;
+      if (input > 1023) input = 1023;
+      const uint16_t value = self->low_ + static_cast<uint16_t>((static_cast<uint32_t>(input) * self->span_) >> 10);
+
+      self->write_compare(value);
+      self->reading_ = reading;
+      self->value_ = value;
+      self->samples_++;
+      return;
+   }
+
+   /********************************************************************************
+   * output: Enumeration fr utsignal.
+   ********************************************************************************/
+   enum class output
+   {
+      oc0a, /* Pin 6 via Timer 0. */
+      oc0b, /* Pin 5 via Timer 0. */
+      oc1a, /* Pin 9 via Timer 1. */
+      oc1b  /* Pin 10 via Timer 1. */
+   };
+};
+
+#endif /* ADC_PWM_HPP_ */
\ No newline at end of file
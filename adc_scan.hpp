@@ -0,0 +1,234 @@
+/********************************************************************************
+* adc_scan.hpp: Innehller funktionalitet fr avlsning av flera analoga
+*               kanaler i en fast sekvens via klassen adc_scan. Varje
+*               AD-omvandling startas automatiskt av hrdvaran vid compare
+*               match p en timerkrets (auto trigger), vilket ger jmnt
+*               frdelade avlsningar utan jitter. I avbrottsrutinen fr
+*               ADC_vect lagras resultatet fr aktuell kanal, varefter
+*               nsta kanal i listan vljs infr nsta AD-omvandling.
+*
+*               Tiden mellan varje AD-omvandling blir samma som tiden mellan
+*               varje timergenererat avbrott fr timerkretsar initierade via
+*               klassen timer, dvs. 0.128 ms. Varje kanal avlses drmed var
+*               0.128 * N:e millisekund, dr N r antalet kanaler i listan.
+*               En AD-omvandling tar cirka 0.108 ms, vilket ryms inom tiden.
+*
+*               Mjliga triggerkllor:
+*
+*               Triggerklla          Timerkrets     Flagga
+*               timer0_compare_a       Timer 0        OCF0A
+*               timer1_compare_b       Timer 1        OCF1B
+********************************************************************************/
+#ifndef ADC_SCAN_HPP_
+#define ADC_SCAN_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "adc_pwm.hpp"
+
+/********************************************************************************
+* adc_scan: Statisk klass fr timerstyrd avlsning av flera analoga kanaler.
+*           Senaste resultat fr varje kanal lagras i en tabell, som kan
+*           lsas av frn huvudprogrammet nr som helst.
+********************************************************************************/
+class adc_scan
+{
+public:
+   enum class trigger; /* Frdeklaration av enumerationsklass fr triggerklla. */
+   static constexpr uint8_t MAX_CHANNELS = 6; /* Maximalt antal kanaler (A0 - A5). */
+
+private:
+   static inline uint8_t channels_[MAX_CHANNELS] = { };          /* Kanaler som ska avlsas. */
+   static inline volatile uint16_t samples_[MAX_CHANNELS] = { }; /* Senaste resultat per kanal. */
+   static inline uint8_t num_channels_ = 0;                      /* Antalet kanaler i listan. */
+   static inline volatile uint8_t index_ = 0;                    /* Index fr pgende kanal. */
+   static inline volatile uint16_t rounds_ = 0;                  /* Antal genomfrda varv. */
+   static inline volatile bool active_ = false;                  /* Indikerar ifall avlsning pgr. */
+   static inline trigger trigger_;                               /* Anvnd triggerklla. */
+
+   /* Prescaler 128 fr AD-omvandlarens klocka (125 kHz vid 16 MHz): */
+   static constexpr uint8_t PRESCALER_ = (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+
+   /********************************************************************************
+   * compare_in_use: Indikerar ifall compare-registret fr angiven triggerklla
+   *                 redan anvnds av en annan funktion. OCR0A anvnds som
+   *                 TOP-vrde eller utsignal av en frekvensgenerator eller
+   *                 PWM-styrning p Timer 0. OCR1B anvnds som utsignal av
+   *                 PWM-styrning samt som trskelvrde av en hndelserknare,
+   *                 som klockar Timer 1 via pin T1.
+   *
+   *                 - source: Triggerkllan som ska kontrolleras.
+   ********************************************************************************/
+   static bool compare_in_use(const trigger source)
+   {
+      if (source == trigger::timer0_compare_a)
+      {
+         return (TCCR0A & ((1 << COM0A1) | (1 << COM0A0) | (1 << WGM01))) ||
+                (TIMSK0 & (1 << OCIE0A));
+      }
+      else
+      {
+         return (TCCR1A & ((1 << COM1B1) | (1 << COM1B0))) || (TIMSK1 & (1 << OCIE1B)) ||
+                (TCCR1B & ((1 << CS12) | (1 << CS11))) == ((1 << CS12) | (1 << CS11));
+      }
+   }
+
+public:
+
+   /********************************************************************************
+   * start: Startar timerstyrd avlsning av angivna kanaler. Angiven timer-
+   *        krets mste vara initierad (exempelvis via ett timer-objekt).
+   *        Vid lyckad start returneras 0, annars felkod 1, exempelvis
+   *        ifall en kanal ligger utanfr 0 - 5 och A0 - A5, ifall AD-
+   *        omvandlaren anvnds fr sluten styrning via klassen adc_pwm
+   *        eller ifall triggerkllans compare-register anvnds av en
+   *        annan funktion (se compare_in_use).
+   *
+   *        - channels    : Pekare till flt innehllande de kanaler som ska
+   *                        avlsas, angivna som 0 - 5 eller A0 - A5.
+   *        - num_channels: Antalet kanaler i fltet (1 - 6).
+   *        - source      : Timerkretsen som ska trigga AD-omvandlingarna.
+   ********************************************************************************/
+   static int start(const uint8_t* channels,
+                    const uint8_t num_channels,
+                    const trigger source)
+   {
+      if (!channels || num_channels == 0 || num_channels > MAX_CHANNELS) return 1;
+      if (adc_pwm::active()) return 1;
+
+      if (source == trigger::timer0_compare_a && (TCCR0B & 0x07) == 0) return 1;
+      if (source == trigger::timer1_compare_b && (TCCR1B & 0x07) == 0) return 1;
+      if (compare_in_use(source)) return 1;
+
+      for (uint8_t i = 0; i < num_channels; ++i)
+      {
+         if (channels[i] > 5 && (channels[i] < 14 || channels[i] > 19)) return 1;
+      }
+
+      stop();
+
+      for (uint8_t i = 0; i < num_channels; ++i)
+      {
+         channels_[i] = channels[i] >= 14 ? channels[i] - 14 : channels[i];
+         samples_[i] = 0;
+      }
+
+      num_channels_ = num_channels;
+      index_ = 0;
+      rounds_ = 0;
+      trigger_ = source;
+
+      if (source == trigger::timer0_compare_a)
+      {
+         OCR0A = 0;
+         TIFR0 = (1 << OCF0A);
+         ADCSRB = (1 << ADTS1) | (1 << ADTS0);
+      }
+      else
+      {
+         OCR1B = 0;
+         TIFR1 = (1 << OCF1B);
+         ADCSRB = (1 << ADTS2) | (1 << ADTS0);
+      }
+
+      ADMUX = (1 << REFS0) | channels_[0];
+      active_ = true;
+      ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIF) | (1 << ADIE) | PRESCALER_;
+      asm("SEI");
+      return 0;
+   }
+
+   /********************************************************************************
+   * stop: Avslutar timerstyrd avlsning. Senast lagrade resultat finns kvar.
+   ********************************************************************************/
+   static void stop(void)
+   {
+      ADCSRA &= ~((1 << ADATE) | (1 << ADIE));
+      ADCSRB = 0;
+      active_ = false;
+      return;
+   }
+
+   /********************************************************************************
+   * active: Indikerar ifall timerstyrd avlsning pgr.
+   ********************************************************************************/
+   static bool active(void)
+   {
+      return active_;
+   }
+
+   /********************************************************************************
+   * rounds: Returnerar antalet varv dr samtliga kanaler har avlsts sedan
+   *         start. Kan anvndas fr att avgra ifall nya resultat finns.
+   ********************************************************************************/
+   static uint16_t rounds(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t rounds = rounds_;
+      SREG = sreg;
+      return rounds;
+   }
+
+   /********************************************************************************
+   * sample: Returnerar senaste resultat fr kanalen p angivet index i
+   *         kanallistan, mellan 0 - 1023.
+   *
+   *         - index: Kanalens index i listan som angavs vid start.
+   ********************************************************************************/
+   static uint16_t sample(const uint8_t index)
+   {
+      if (index >= num_channels_) return 0;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t sample = samples_[index];
+      SREG = sreg;
+      return sample;
+   }
+
+   /********************************************************************************
+   * on_conversion_complete: Lagrar resultatet fr aktuell kanal och vljer
+   *                         nsta kanal i listan. Eftersom nsta AD-omvandling
+   *                         startas frst vid nsta compare match hinner
+   *                         kanalbytet ske innan dess. Triggerflaggan
+   *                         nollstlls, s att nsta compare match ger en
+   *                         ny stigande flank. Ska anropas frn
+   *                         avbrottsrutinen fr ADC_vect.
+   ********************************************************************************/
+   static void on_conversion_complete(void)
+   {
+      uint8_t index = index_;
+      samples_[index] = ADC;
+
+      if (++index >= num_channels_)
+      {
+         index = 0;
+         rounds_++;
+      }
+
+      index_ = index;
+      ADMUX = (1 << REFS0) | channels_[index];
+
+      if (trigger_ == trigger::timer0_compare_a)
+      {
+         TIFR0 = (1 << OCF0A);
+      }
+      else
+      {
+         TIFR1 = (1 << OCF1B);
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * trigger: Enumeration fr val av triggerklla.
+   ********************************************************************************/
+   enum class trigger
+   {
+      timer0_compare_a, /* Compare match A p Timer 0. */
+      timer1_compare_b  /* Compare match B p Timer 1. */
+   };
+};
+
+#endif /* ADC_SCAN_HPP_ */
\ No newline at end of file
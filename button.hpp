@@ -10,6 +10,7 @@
 
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
+#include "pin_map.hpp"
 
 /********************************************************************************
 * button: Klass fr implementering av tryckknappar och andra digitala inportar.
@@ -34,28 +35,19 @@ public:
    ********************************************************************************/
    button(const uint8_t pin)
    {
-      if (pin >= 0 && pin <= 7)
-      {
-         this->io_port_ = io_port::d;
-         this->pin_ = pin;
-         PORTD |= (1 << this->pin_);
-      }
-      else if (pin >= 8 && pin <= 13)
+      pin_map::resolve(pin, this->io_port_, this->pin_);
+
+      if (this->io_port_ == io_port::b)
       {
-         this->io_port_ = io_port::b;
-         this->pin_ = pin - 8;
          PORTB |= (1 << this->pin_);
       }
-      else if (pin >= 14 && pin <= 19)
+      else if (this->io_port_ == io_port::c)
       {
-         this->io_port_ = io_port::c;
-         this->pin_ = pin - 14;
          PORTC |= (1 << this->pin_);
       }
-      else
+      else if (this->io_port_ == io_port::d)
       {
-         this->io_port_ = io_port::none;
-         this->pin_ = 0;
+         PORTD |= (1 << this->pin_);
       }
 
       this->interrupt_enabled_ = false;
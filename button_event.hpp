@@ -0,0 +1,291 @@
+/********************************************************************************
+* button_event.hpp: Innehller funktionalitet fr detektering av gester p
+*                   tryckknappar via klassen button_event_detector. Detektorn
+*                   lggs ovanp ett befintligt button-objekt och genererar
+*                   tidsstmplade event (nedtryckning, uppslppning, lngt
+*                   tryck, upprepning samt dubbelklick), som placeras i en k.
+*
+*                   Detekteringen drivs av den delade ticken i klassen timer,
+*                   dvs. samtliga detektorer registreras vid skapandet och
+*                   uppdateras frn en och samma avbrottsrutin med tickvrdet
+*                   frn timer::ticks. Applikationen lser sedan eventen frn
+*                   kn i stllet fr att polla tryckknapparnas pinnar.
+*                   Samtliga tider anges i antalet tickar  0.128 ms.
+*
+*                   Funktionen button_event_detector::on_shared_tick ska
+*                   anropas i avbrottsrutinen fr TIMER2_COMPA_vect efter
+*                   timer::on_shared_tick, exempelvis enligt nedan:
+*
+*                   static void timer2_compa_handler(void)
+*                   {
+*                      timer::on_shared_tick();
+*                      button_event_detector::on_shared_tick();
+*                   }
+********************************************************************************/
+#ifndef BUTTON_EVENT_HPP_
+#define BUTTON_EVENT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "button.hpp"
+#include "ring_buffer.hpp"
+#include "timer.hpp"
+
+/********************************************************************************
+* button_event: Strukt fr lagring av ett tidsstmplat event frn en
+*               tryckknapp.
+********************************************************************************/
+struct button_event
+{
+   enum class type; /* Frdeklaration av enumerationsklass fr typ av event. */
+
+   const button* source = nullptr; /* Tryckknappen som genererade eventet. */
+   type event = type::none;        /* Typ av event. */
+   uint32_t timestamp = 0;         /* Tickvrde nr eventet detekterades. */
+
+   /********************************************************************************
+   * type: Enumeration fr typ av event.
+   ********************************************************************************/
+   enum class type
+   {
+      none,        /* Inget event. */
+      press,       /* Tryckknappen trycktes ned. */
+      release,     /* Tryckknappen slpptes upp. */
+      long_press,  /* Tryckknappen har hllits nedtryckt en lngre tid. */
+      repeat,      /* Upprepat event medan tryckknappen hlls nedtryckt. */
+      double_click /* Andra nedtryckningen inom tidsfnstret fr dubbelklick. */
+   };
+};
+
+/* K fr tidsstmplade tryckknappsevent, som kan delas av flera detektorer: */
+typedef ring_buffer<button_event, 8> button_event_queue;
+
+/********************************************************************************
+* button_event_detector: Klass fr detektering av gester p en tryckknapp.
+*                        Pinnens niv mste vara stabil under avstudsnings-
+*                        tiden innan en nivndring accepteras, vilket gr
+*                        att PCI-avbrott inte behver inaktiveras vid
+*                        kontaktstudsar. Samtliga detektorer lagras i en
+*                        lnkad lista och uppdateras via on_shared_tick.
+********************************************************************************/
+class button_event_detector
+{
+private:
+   static inline button_event_detector* detectors_ = nullptr; /* Lista med registrerade detektorer. */
+   button_event_detector* next_ = nullptr;       /* Nsta detektor i listan. */
+   bool valid_ = false;                          /* Indikerar ifall den delade ticken kunde startas. */
+   const button& button_;                        /* Tryckknappen som avlses. */
+   button_event_queue& queue_;                   /* K som genererade event placeras i. */
+   uint16_t debounce_ticks_ = DEBOUNCE_TICKS;         /* Avstudsningstid. */
+   uint16_t long_press_ticks_ = LONG_PRESS_TICKS;     /* Tid till lngt tryck. */
+   uint16_t repeat_ticks_ = REPEAT_TICKS;             /* Tid mellan upprepningar (0 = av). */
+   uint16_t double_click_ticks_ = DOUBLE_CLICK_TICKS; /* Tidsfnster fr dubbelklick. */
+   uint32_t last_change_ = 0;                    /* Tickvrde vid senaste nivndring. */
+   uint32_t pressed_at_ = 0;                     /* Tickvrde vid senaste nedtryckning. */
+   uint32_t released_at_ = 0;                    /* Tickvrde vid senaste uppslppning. */
+   uint32_t next_repeat_ = 0;                    /* Tickvrde fr nsta upprepning. */
+   bool raw_level_ = false;                      /* Senast avlsta (ostabila) niv. */
+   bool pressed_ = false;                        /* Avstudsad niv, true = nedtryckt. */
+   bool long_pressed_ = false;                   /* Indikerar ifall lngt tryck har rapporterats. */
+   bool click_pending_ = false;                  /* Indikerar ifall ett klick vntar p ett andra. */
+
+   /********************************************************************************
+   * emit: Placerar ett event av angiven typ i kn. Ifall kn r full kastas
+   *       eventet, s att avbrottsrutinen aldrig blockeras.
+   *
+   *       - type: Typ av event.
+   *       - now : Aktuellt tickvrde, som anvnds som tidsstmpel.
+   ********************************************************************************/
+   void emit(const button_event::type type,
+             const uint32_t now)
+   {
+      button_event event;
+      event.source = &this->button_;
+      event.event = type;
+      event.timestamp = now;
+      static_cast<void>(this->queue_.push(event));
+      return;
+   }
+
+public:
+
+   /* Standardtider mtt i tickar  0.128 ms: */
+   static constexpr uint16_t DEBOUNCE_TICKS = 156;      /* Cirka 20 ms. */
+   static constexpr uint16_t LONG_PRESS_TICKS = 7813;   /* Cirka 1000 ms. */
+   static constexpr uint16_t REPEAT_TICKS = 1953;       /* Cirka 250 ms. */
+   static constexpr uint16_t DOUBLE_CLICK_TICKS = 3125; /* Cirka 400 ms. */
+
+   /********************************************************************************
+   * button_event_detector: Initierar ny detektor fr angiven tryckknapp,
+   *                        registrerar den fr uppdatering via den delade
+   *                        ticken samt startar ticken. Ifall den delade
+   *                        ticken inte kan startas, eftersom Timer 2 r
+   *                        reserverad, genereras inga event, vilket kan
+   *                        kontrolleras via valid.
+   *
+   *                        - source: Referens till tryckknappen som ska avlsas.
+   *                        - queue : Referens till kn dr event ska placeras.
+   ********************************************************************************/
+   button_event_detector(const button& source,
+                         button_event_queue& queue)
+      : button_(source), queue_(queue)
+   {
+      this->raw_level_ = this->button_.is_pressed();
+      this->pressed_ = this->raw_level_;
+
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->next_ = detectors_;
+      detectors_ = this;
+      SREG = sreg;
+
+      this->valid_ = timer::start_shared_tick() == 0;
+      return;
+   }
+
+   /********************************************************************************
+   * ~button_event_detector: Tar bort detektorn frn listan med registrerade
+   *                         detektorer.
+   ********************************************************************************/
+   ~button_event_detector(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      for (button_event_detector** i = &detectors_; *i; i = &(*i)->next_)
+      {
+         if (*i == this)
+         {
+            *i = this->next_;
+            break;
+         }
+      }
+
+      SREG = sreg;
+      return;
+   }
+
+   button_event_detector(const button_event_detector&) = delete;
+   button_event_detector& operator=(const button_event_detector&) = delete;
+
+   /********************************************************************************
+   * valid: Indikerar ifall den delade ticken, som driver detektorn, lper.
+   ********************************************************************************/
+   bool valid(void) const
+   {
+      return this->valid_;
+   }
+
+   /********************************************************************************
+   * on_shared_tick: Uppdaterar samtliga registrerade detektorer med aktuellt
+   *                 vrde p den delade tickrknaren. Ska anropas frn
+   *                 avbrottsrutinen fr TIMER2_COMPA_vect efter anrop av
+   *                 timer::on_shared_tick.
+   ********************************************************************************/
+   static void on_shared_tick(void)
+   {
+      const uint32_t now = timer::ticks();
+
+      for (button_event_detector* i = detectors_; i; i = i->next_)
+      {
+         i->update(now);
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * set_timing: Stter nya tider fr detekteringen, mtt i antalet tickar.
+   *
+   *             - debounce_ticks    : Tid som nivn mste vara stabil.
+   *             - long_press_ticks  : Tid tills lngt tryck rapporteras.
+   *             - repeat_ticks      : Tid mellan upprepningar efter lngt tryck
+   *                                   (0 = inga upprepningar).
+   *             - double_click_ticks: Hgsta tid mellan uppslppning och ny
+   *                                   nedtryckning fr dubbelklick.
+   ********************************************************************************/
+   void set_timing(const uint16_t debounce_ticks,
+                   const uint16_t long_press_ticks,
+                   const uint16_t repeat_ticks,
+                   const uint16_t double_click_ticks)
+   {
+      this->debounce_ticks_ = debounce_ticks;
+      this->long_press_ticks_ = long_press_ticks;
+      this->repeat_ticks_ = repeat_ticks;
+      this->double_click_ticks_ = double_click_ticks;
+      return;
+   }
+
+   /********************************************************************************
+   * pressed: Indikerar ifall tryckknappen r nedtryckt efter avstudsning.
+   ********************************************************************************/
+   bool pressed(void) const
+   {
+      return this->pressed_;
+   }
+
+   /********************************************************************************
+   * update: Avlser tryckknappen och genererar eventuella event. Anropas
+   *         vid varje delad tick via on_shared_tick.
+   *
+   *         - now: Aktuellt vrde p den delade tickrknaren.
+   ********************************************************************************/
+   void update(const uint32_t now)
+   {
+      const bool level = this->button_.is_pressed();
+
+      if (level != this->raw_level_)
+      {
+         this->raw_level_ = level;
+         this->last_change_ = now;
+      }
+      else if (level != this->pressed_ && now - this->last_change_ >= this->debounce_ticks_)
+      {
+         this->pressed_ = level;
+
+         if (this->pressed_)
+         {
+            this->pressed_at_ = now;
+            this->long_pressed_ = false;
+            this->emit(button_event::type::press, now);
+
+            if (this->click_pending_ && now - this->released_at_ <= this->double_click_ticks_)
+            {
+               this->click_pending_ = false;
+               this->emit(button_event::type::double_click, now);
+            }
+            else
+            {
+               this->click_pending_ = true;
+            }
+         }
+         else
+         {
+            this->released_at_ = now;
+            if (this->long_pressed_) this->click_pending_ = false;
+            this->emit(button_event::type::release, now);
+         }
+      }
+      else if (this->pressed_)
+      {
+         if (!this->long_pressed_)
+         {
+            if (now - this->pressed_at_ >= this->long_press_ticks_)
+            {
+               this->long_pressed_ = true;
+               this->next_repeat_ = now + this->repeat_ticks_;
+               this->emit(button_event::type::long_press, now);
+            }
+         }
+         else if (this->repeat_ticks_ && static_cast<int32_t>(now - this->next_repeat_) >= 0)
+         {
+            this->next_repeat_ += this->repeat_ticks_;
+            this->emit(button_event::type::repeat, now);
+         }
+      }
+
+      return;
+   }
+};
+
+#endif /* BUTTON_EVENT_HPP_ */
\ No newline at end of file
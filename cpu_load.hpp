@@ -0,0 +1,160 @@
+/********************************************************************************
+* cpu_load.hpp: Innehller funktionalitet fr mtning av processorns
+*               belastning via den statiska klassen cpu_load. Mtningen sker
+*               via rkning av tid i huvudprogrammets tomgngsloop, dr idle
+*               anropas vid varje varv. Tiden mellan tv anrop mts via
+*               timer::timestamp. Ett varv som inte avbryts tar en kort och
+*               konstant tid, som kalibreras automatiskt som kortaste
+*               uppmtta tid. Ifall ett varv tar lngre tid har avbrott gt
+*               rum under varvet, dr endast den kalibrerade tiden rknas som
+*               ledig tid och resten som upptagen tid.
+*
+*               Belastningen berknas fr fnster om 100 ms, dr medelvrdet
+*               av de tta senaste fnstren utgr aktuell belastning (glidande
+*               fnster om 800 ms). Hgsta belastning i ett enskilt fnster
+*               sparas som toppvrde.
+*
+*               Eftersom mtningen sker i tomgngsloopen ska huvudprogrammet
+*               inte frsttas i vilolge medan mtning pgr.
+********************************************************************************/
+#ifndef CPU_LOAD_HPP_
+#define CPU_LOAD_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+#include "serial.hpp"
+
+/********************************************************************************
+* cpu_load: Statisk klass fr mtning av processorns belastning.
+********************************************************************************/
+class cpu_load
+{
+public:
+   static constexpr uint8_t NUM_WINDOWS = 8; /* Antal fnster i glidande medelvrde. */
+
+private:
+   static constexpr uint32_t WINDOW_COUNTS_ = 200000; /* 100 ms i enheten 0.5 s. */
+   static inline uint32_t last_ = 0;                  /* Tidsstmpel vid senaste anrop. */
+   static inline uint32_t window_start_ = 0;          /* Tidsstmpel nr fnstret startade. */
+   static inline uint32_t idle_ = 0;                  /* Ledig tid i aktuellt fnster. */
+   static inline uint16_t loop_counts_ = UINT16_MAX;  /* Kalibrerad tid fr ett varv. */
+   static inline uint8_t windows_[NUM_WINDOWS] = { }; /* Belastning i de senaste fnstren. */
+   static inline uint8_t index_ = 0;                  /* Index fr nsta fnster. */
+   static inline uint8_t peak_ = 0;                   /* Hgsta belastning i ett fnster. */
+   static inline bool started_ = false;               /* Indikerar ifall mtning pgr. */
+
+   /********************************************************************************
+   * close_window: Berknar belastningen i avslutat fnster och startar nsta.
+   *
+   *               - now: Aktuell tidsstmpel.
+   ********************************************************************************/
+   static void close_window(const uint32_t now)
+   {
+      const uint32_t length = now - window_start_;
+      const uint32_t idle = idle_ < length ? idle_ : length;
+      const uint8_t load = static_cast<uint8_t>(100 - (idle * 100 + length / 2) / length);
+
+      windows_[index_] = load;
+      if (++index_ >= NUM_WINDOWS) index_ = 0;
+      if (load > peak_) peak_ = load;
+
+      window_start_ = now;
+      idle_ = 0;
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * init: Startar mtning samt den delade ticken, som krvs fr tidmtningen.
+   *       Vid lyckad start returneras 0. Ifall den delade ticken inte kan
+   *       startas, eftersom Timer 2 r reserverad, returneras felkod 1 och
+   *       mtningen startas inte.
+   ********************************************************************************/
+   static int init(void)
+   {
+      if (timer::start_shared_tick()) return 1;
+      last_ = timer::timestamp();
+      window_start_ = last_;
+      idle_ = 0;
+      started_ = true;
+      return 0;
+   }
+
+   /********************************************************************************
+   * idle: Registrerar ett varv i tomgngsloopen. Ska anropas vid varje varv
+   *       i huvudprogrammets while-loop.
+   ********************************************************************************/
+   static void idle(void)
+   {
+      if (!started_) return;
+      const uint32_t now = timer::timestamp();
+      const uint32_t delta = now - last_;
+      last_ = now;
+
+      if (delta && delta < loop_counts_)
+      {
+         loop_counts_ = static_cast<uint16_t>(delta);
+      }
+
+      idle_ += delta <= 2UL * loop_counts_ ? delta : loop_counts_;
+
+      if (now - window_start_ >= WINDOW_COUNTS_)
+      {
+         close_window(now);
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * load: Returnerar aktuell belastning i procent (0 - 100) som medelvrdet
+   *       av de tta senaste fnstren.
+   ********************************************************************************/
+   static uint8_t load(void)
+   {
+      uint16_t sum = 0;
+
+      for (const auto i : windows_)
+      {
+         sum += i;
+      }
+
+      return static_cast<uint8_t>((sum + NUM_WINDOWS / 2) / NUM_WINDOWS);
+   }
+
+   /********************************************************************************
+   * peak: Returnerar hgsta belastning i procent i ett enskilt fnster
+   *       sedan start eller senaste anrop av reset_peak.
+   ********************************************************************************/
+   static uint8_t peak(void)
+   {
+      return peak_;
+   }
+
+   /********************************************************************************
+   * reset_peak: Nollstller toppvrdet.
+   ********************************************************************************/
+   static void reset_peak(void)
+   {
+      peak_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * report: Skickar aktuell belastning samt toppvrde i procent via USART0
+   *         som rader p formen "namn=vrde". USART0 mste vara initierad
+   *         via serial::init. Vid lyckad verfring returneras 0, annars
+   *         felkod 1.
+   ********************************************************************************/
+   static int report(void)
+   {
+      int result = 0;
+      result |= serial::print_value("load", load());
+      result |= serial::print_value("peak", peak());
+      return result;
+   }
+};
+
+#endif /* CPU_LOAD_HPP_ */
\ No newline at end of file
@@ -0,0 +1,271 @@
+/********************************************************************************
+* cyclic_executive.hpp: Innehller funktionalitet fr statisk schemalggning
+*                       av periodiska jobb via klassmallen cyclic_executive.
+*                       I stllet fr att varje periodiskt jobb anvnder en
+*                       egen timerkrets deklareras samtliga jobb med period
+*                       samt fasfrskjutning i en tabell. Vid kompilering
+*                       berknas hyperperioden (minsta gemensamma multipel
+*                       av perioderna) samt delramens lngd (strsta
+*                       gemensamma delare av perioder och fasfrskjutningar),
+*                       varefter en tabell med vilka jobb som ska exekveras
+*                       i respektive delram genereras och lagras i
+*                       programminnet (PROGMEM).
+*
+*                       En enda timer lper ut en gng per delram, varvid
+*                       avbrottsrutinen stegar till nsta delram i tabellen
+*                       och exekverar angivna jobb i tabellordning. Drmed
+*                       fattas inga schemalggningsbeslut under krning och
+*                       tidsfrloppet upprepas exakt varje hyperperiod.
+*
+*                       Exempel:
+*
+*                       constexpr cyclic_job jobs[] =
+*                       {
+*                          { blink, 100, 0 },
+*                          { debounce, 300, 0 },
+*                          { sample, 20, 10 }
+*                       };
+*
+*                       cyclic_executive<jobs> executive;
+*
+*                       Ovanstende ger delramar om 10 ms samt en hyperperiod
+*                       om 300 ms, dvs. en tabell med 30 delramar.
+********************************************************************************/
+#ifndef CYCLIC_EXECUTIVE_HPP_
+#define CYCLIC_EXECUTIVE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+#include <avr/pgmspace.h>
+
+/********************************************************************************
+* cyclic_job: Strukt fr deklaration av ett periodiskt jobb.
+********************************************************************************/
+struct cyclic_job
+{
+   void (*run)(void);  /* Jobbet, anropas frn timerns avbrottsrutin. */
+   uint16_t period_ms; /* Jobbets period mtt i millisekunder. */
+   uint16_t offset_ms; /* Fasfrskjutning mtt i millisekunder (mindre n perioden). */
+};
+
+/********************************************************************************
+* cyclic_executive: Klassmall fr cyklisk exekvering av jobben i tabellen
+*                   JOBS, som mste vara deklarerad constexpr med statisk
+*                   livslngd. Hgst tta jobb samt 256 delramar stds.
+*                   Eftersom tillstndet delas av samtliga instanser med
+*                   samma tabell fr endast en instans skapas per tabell.
+*                   Jobben exekveras i avbrottsrutinen och ska drmed vara
+*                   korta; samtliga jobb i en delram br rymmas inom
+*                   delramens lngd.
+********************************************************************************/
+template<const auto& JOBS>
+class cyclic_executive
+{
+public:
+   static constexpr uint8_t NUM_JOBS = sizeof(JOBS) / sizeof(JOBS[0]); /* Antal jobb. */
+
+private:
+   static_assert(NUM_JOBS >= 1 && NUM_JOBS <= 8, "Antalet jobb mste vara mellan 1 - 8!");
+
+   /********************************************************************************
+   * gcd: Returnerar strsta gemensamma delare av angivna tal.
+   ********************************************************************************/
+   static constexpr uint32_t gcd(const uint32_t a,
+                                 const uint32_t b)
+   {
+      return b ? gcd(b, a % b) : a;
+   }
+
+   /********************************************************************************
+   * minor_frame: Returnerar delramens lngd i millisekunder, dvs. strsta
+   *              gemensamma delare av samtliga perioder och fasfrskjutningar.
+   ********************************************************************************/
+   static constexpr uint32_t minor_frame(void)
+   {
+      uint32_t result = 0;
+
+      for (uint8_t i = 0; i < NUM_JOBS; ++i)
+      {
+         result = gcd(result, JOBS[i].period_ms);
+         if (JOBS[i].offset_ms) result = gcd(result, JOBS[i].offset_ms);
+      }
+
+      return result;
+   }
+
+   /********************************************************************************
+   * hyperperiod: Returnerar hyperperioden i millisekunder, dvs. minsta
+   *              gemensamma multipel av samtliga perioder, alternativt 0
+   *              ifall hyperperioden inte ryms i 32 bitar.
+   ********************************************************************************/
+   static constexpr uint32_t hyperperiod(void)
+   {
+      uint32_t result = 1;
+
+      for (uint8_t i = 0; i < NUM_JOBS; ++i)
+      {
+         const uint32_t factor = result / gcd(result, JOBS[i].period_ms);
+         if (factor > UINT32_MAX / JOBS[i].period_ms) return 0;
+         result = factor * JOBS[i].period_ms;
+      }
+
+      return result;
+   }
+
+   /********************************************************************************
+   * valid_jobs: Indikerar ifall samtliga jobb har en period samt en fas-
+   *             frskjutning mindre n perioden.
+   ********************************************************************************/
+   static constexpr bool valid_jobs(void)
+   {
+      for (uint8_t i = 0; i < NUM_JOBS; ++i)
+      {
+         if (!JOBS[i].run || !JOBS[i].period_ms || JOBS[i].offset_ms >= JOBS[i].period_ms) return false;
+      }
+
+      return true;
+   }
+
+   static_assert(valid_jobs(), "Varje jobb mste ha en period samt en fasfrskjutning mindre n perioden!");
+
+public:
+   static constexpr uint16_t MINOR_FRAME_MS = minor_frame();               /* Delramens lngd. */
+   static constexpr uint32_t HYPERPERIOD_MS = hyperperiod();               /* Hyperperiodens lngd. */
+
+private:
+   static_assert(HYPERPERIOD_MS != 0, "Hyperperioden ryms inte i 32 bitar!");
+   static_assert(HYPERPERIOD_MS / MINOR_FRAME_MS <= 256, "Hyperperioden fr omfatta hgst 256 delramar!");
+
+public:
+   static constexpr uint16_t NUM_FRAMES = HYPERPERIOD_MS / MINOR_FRAME_MS; /* Antal delramar. */
+
+private:
+
+   /********************************************************************************
+   * table_t: Strukt fr tabellen med jobb per delram, dr bit i anger ifall
+   *          jobb i ska exekveras i delramen.
+   ********************************************************************************/
+   struct table_t
+   {
+      uint8_t masks[NUM_FRAMES];
+   };
+
+   /********************************************************************************
+   * make_table: Genererar tabellen med jobb per delram vid kompilering.
+   ********************************************************************************/
+   static constexpr table_t make_table(void)
+   {
+      table_t table = { };
+
+      for (uint16_t frame = 0; frame < NUM_FRAMES; ++frame)
+      {
+         const uint32_t time_ms = static_cast<uint32_t>(frame) * MINOR_FRAME_MS;
+
+         for (uint8_t i = 0; i < NUM_JOBS; ++i)
+         {
+            if ((time_ms + JOBS[i].period_ms - JOBS[i].offset_ms) % JOBS[i].period_ms == 0)
+            {
+               table.masks[frame] |= (1 << i);
+            }
+         }
+      }
+
+      return table;
+   }
+
+   static constexpr table_t table_ PROGMEM = make_table(); /* Jobb per delram. */
+   static inline volatile uint8_t frame_ = 0;               /* Nsta delram. */
+   static inline volatile uint32_t cycles_ = 0;             /* Antal genomfrda hyperperioder. */
+   timer_for<MINOR_FRAME_MS> frame_timer_;                  /* Timer som lper ut varje delram. */
+
+   /********************************************************************************
+   * on_frame: Exekverar jobben i aktuell delram och stegar till nsta
+   *           delram. Anropas frn timerns avbrottsrutin.
+   ********************************************************************************/
+   static void on_frame(void)
+   {
+      const uint8_t frame = frame_;
+      const uint8_t mask = pgm_read_byte(&table_.masks[frame]);
+
+      for (uint8_t i = 0; i < NUM_JOBS; ++i)
+      {
+         if (mask & (1 << i)) JOBS[i].run();
+      }
+
+      if (frame + 1U >= NUM_FRAMES)
+      {
+         frame_ = 0;
+         cycles_++;
+      }
+      else
+      {
+         frame_ = frame + 1;
+      }
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * cyclic_executive: Initierar ny cyklisk exekvering, dr en timer med
+   *                   delramens lngd reserveras. Exekveringen startas
+   *                   via start.
+   *
+   *                   - timer_sel: Val av timerkrets (default = frsta
+   *                                lediga timerkrets, annars mjukvarutimer).
+   ********************************************************************************/
+   cyclic_executive(const timer::sel timer_sel = timer::sel::automatic)
+      : frame_timer_(timer_sel, on_frame) { }
+
+   /********************************************************************************
+   * start: Startar exekveringen frn frsta delramen.
+   ********************************************************************************/
+   void start(void)
+   {
+      this->frame_timer_.reset();
+      frame_ = 0;
+      cycles_ = 0;
+      this->frame_timer_.enable_interrupt();
+      return;
+   }
+
+   /********************************************************************************
+   * stop: Stoppar exekveringen efter pgende delram.
+   ********************************************************************************/
+   void stop(void)
+   {
+      this->frame_timer_.disable_interrupt();
+      return;
+   }
+
+   /********************************************************************************
+   * running: Indikerar ifall exekveringen pgr.
+   ********************************************************************************/
+   bool running(void) const
+   {
+      return this->frame_timer_.interrupt_enabled();
+   }
+
+   /********************************************************************************
+   * frame: Returnerar index fr nsta delram som ska exekveras.
+   ********************************************************************************/
+   uint8_t frame(void) const
+   {
+      return frame_;
+   }
+
+   /********************************************************************************
+   * cycles: Returnerar antalet genomfrda hyperperioder sedan start.
+   ********************************************************************************/
+   uint32_t cycles(void) const
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint32_t cycles = cycles_;
+      SREG = sreg;
+      return cycles;
+   }
+};
+
+#endif /* CYCLIC_EXECUTIVE_HPP_ */
\ No newline at end of file
@@ -0,0 +1,147 @@
+/********************************************************************************
+* delay.hpp: Innehller funktionalitet fr frdrjningar via den statiska
+*            klassen delay. Frdrjningar mtt i millisekunder baseras p
+*            tidsstmpeln i klassen timer (den delade ticken), dr processorn
+*            frstts i vilolge (Idle) mellan varje tick. Drmed frbrukas
+*            mindre strm, samtidigt som frdrjningen frblir exakt ven nr
+*            avbrott ger rum under tiden, eftersom tiden mts mot en absolut
+*            deadline i stllet fr att rknas i en loop.
+*
+*            Fr korta vntetider finns busy wait-varianter: us, vars
+*            anropsoverhead r kalibrerad bort, samt cycles, som ger en exakt
+*            frdrjning mtt i klockcykler. Dessa frlngs dock ifall avbrott
+*            ger rum under frdrjningen.
+********************************************************************************/
+#ifndef DELAY_HPP_
+#define DELAY_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+#include <avr/sleep.h>
+#include <util/delay_basic.h>
+
+/********************************************************************************
+* delay: Statisk klass fr frdrjningar.
+********************************************************************************/
+class delay
+{
+private:
+   static constexpr uint16_t COUNTS_PER_MS_ = 2000;  /* Tidsstmpelns upplsning r 0.5 s. */
+   static constexpr uint16_t COUNTS_PER_TICK_ = 256; /* Antal 0.5 s per delad tick. */
+   static constexpr uint16_t MAX_LOOP_US_ = 16000;   /* Lngsta vntetid per _delay_loop_2. */
+
+   /********************************************************************************
+   * wait: Vntar angivet antal enheter  0.5 s. Processorn frstts i
+   *       vilolge s lnge minst en hel tick terstr, varefter resterande
+   *       tid vntas ut via tidsstmpeln. Ifall avbrott r inaktiverade,
+   *       exempelvis vid anrop frn en avbrottsrutin, eller ifall den
+   *       delade ticken inte kan startas, eftersom Timer 2 r reserverad,
+   *       anvnds busy wait.
+   *
+   *       - counts: Vntetid i enheten 0.5 s.
+   ********************************************************************************/
+   static void wait(uint32_t counts)
+   {
+      if (!(SREG & (1 << SREG_I)) || timer::start_shared_tick())
+      {
+         while (counts >= COUNTS_PER_MS_)
+         {
+            us(1000);
+            counts -= COUNTS_PER_MS_;
+         }
+
+         us(static_cast<uint16_t>(counts / 2));
+         return;
+      }
+
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      const uint32_t start = timer::timestamp();
+
+      while (true)
+      {
+         const uint32_t elapsed = timer::timestamp() - start;
+         if (elapsed >= counts) break;
+
+         if (counts - elapsed > COUNTS_PER_TICK_)
+         {
+            asm("CLI");
+            sleep_enable();
+            asm("SEI");
+            sleep_cpu();
+            sleep_disable();
+         }
+      }
+
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * ms: Genererar frdrjning mtt i millisekunder, dr processorn frstts
+   *     i vilolge under frdrjningen. Noggrannheten r 0.5 s oavsett
+   *     avbrott som ger rum under tiden, frutsatt att dessa inte tar
+   *     lngre tid n terstende frdrjning.
+   *
+   *     - time_ms: Frdrjningstid mtt i millisekunder.
+   ********************************************************************************/
+   static void ms(const uint16_t time_ms)
+   {
+      wait(static_cast<uint32_t>(time_ms) * COUNTS_PER_MS_);
+      return;
+   }
+
+   /********************************************************************************
+   * sleep_us: Genererar frdrjning mtt i mikrosekunder, dr processorn
+   *           frstts i vilolge under frdrjningen. Lmplig fr lngre
+   *           vntetider mtt i mikrosekunder, exempelvis 500 s.
+   *
+   *           - time_us: Frdrjningstid mtt i mikrosekunder.
+   ********************************************************************************/
+   static void sleep_us(const uint32_t time_us)
+   {
+      wait(time_us * 2);
+      return;
+   }
+
+   /********************************************************************************
+   * us: Genererar frdrjning mtt i mikrosekunder via busy wait, dr
+   *     frdrjningen genereras av _delay_loop_2 (fyra klockcykler per
+   *     varv). Anropets overhead (cirka 16 klockcykler, dvs. 1 s) dras av
+   *     frn vntetiden, s att frdrjningen inte driver ivg som vid
+   *     upprepade anrop av _delay_us(1). Frdrjningar under 2 s ger
+   *     ingen extra vntan.
+   *
+   *     - time_us: Frdrjningstid mtt i mikrosekunder.
+   ********************************************************************************/
+   static void us(const uint16_t time_us)
+   {
+      if (time_us < 2) return;
+      uint16_t remaining = time_us - 1;
+
+      while (remaining > MAX_LOOP_US_)
+      {
+         _delay_loop_2(MAX_LOOP_US_ * (F_CPU / 4000000UL));
+         remaining -= MAX_LOOP_US_;
+      }
+
+      _delay_loop_2(remaining * (F_CPU / 4000000UL));
+      return;
+   }
+
+   /********************************************************************************
+   * cycles: Genererar frdrjning om exakt angivet antal klockcykler via
+   *         busy wait. Antalet klockcykler mste vara knt vid kompilering.
+   *
+   *         - CYCLES: Frdrjningstid mtt i klockcykler (62.5 ns vid 16 MHz).
+   ********************************************************************************/
+   template<uint32_t CYCLES>
+   static void cycles(void)
+   {
+      __builtin_avr_delay_cycles(CYCLES);
+      return;
+   }
+};
+
+#endif /* DELAY_HPP_ */
\ No newline at end of file
@@ -0,0 +1,368 @@
+/********************************************************************************
+* event_counter.hpp: Innehller funktionalitet fr rkning av externa pulser
+*                    i hrdvara via klassen event_counter. Timer 0 eller
+*                    Timer 1 klockas d frn pin T0 respektive T1 i stllet
+*                    fr frn systemklockan, s att varje puls rknas upp
+*                    direkt av timerkretsen utan ngot avbrott. Endast vid
+*                    overflow sker ett avbrott, dr antalet overflows rknas
+*                    upp, vilket utkar rknaren till 32 bitar. Drmed kan
+*                    pulstg med hg frekvens (upp till cirka 6 MHz vid 16 MHz
+*                    systemklocka) rknas utan belastning per puls.
+*
+*                    Ett trskelvrde kan anges, dr en callbackrutin anropas
+*                    nr rknaren nr trskelvrdet. Detta sker via compare
+*                    match B p timerkretsen, som aktiveras frst nr
+*                    rknarens vre bitar verensstmmer med trskelvrdet.
+*
+*                    Timerkretsen reserveras via klassen timer och kan drmed
+*                    inte anvndas av ngot timer-objekt samtidigt.
+*
+*                    Insignal     pin (Arduino Uno)     Timerkrets
+*                       T0         4 (PORTD4)            Timer 0
+*                       T1         5 (PORTD5)            Timer 1
+*
+*                    Avbrottsrutinerna ska anropa on_overflow respektive
+*                    on_compare med aktuell insignal:
+*
+*                    Avbrottsvektor        Anrop
+*                    TIMER0_OVF_vect       event_counter::on_overflow(input::t0)
+*                    TIMER0_COMPB_vect     event_counter::on_compare(input::t0)
+*                    TIMER1_OVF_vect       event_counter::on_overflow(input::t1)
+*                    TIMER1_COMPB_vect     event_counter::on_compare(input::t1)
+********************************************************************************/
+#ifndef EVENT_COUNTER_HPP_
+#define EVENT_COUNTER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+
+/********************************************************************************
+* event_counter: Klass fr rkning av externa pulser p pin T0 eller T1.
+********************************************************************************/
+class event_counter
+{
+public:
+   enum class input; /* Frdeklaration av enumerationsklass fr insignal. */
+   enum class edge;  /* Frdeklaration av enumerationsklass fr flank. */
+   typedef void (*callback)(void); /* Callbackrutin vid uppntt trskelvrde. */
+
+private:
+   basic_timer<uint8_t> circuit_;        /* Reservation av timerkretsen. */
+   input input_;                         /* Anvnd insignal. */
+   volatile uint32_t overflows_ = 0;     /* Antal overflows sedan start. */
+   uint32_t threshold_ = 0;              /* Trskelvrde. */
+   callback callback_ = nullptr;         /* Callbackrutin vid uppntt trskelvrde. */
+   bool threshold_armed_ = false;        /* Indikerar ifall trskelvrdet r aktivt. */
+   bool valid_ = false;                  /* Indikerar ifall timerkretsen reserverades. */
+   static inline event_counter* instances_[2] = { }; /* Rknare per insignal. */
+
+   /********************************************************************************
+   * bits: Returnerar antalet bitar i timerkretsens rknare.
+   ********************************************************************************/
+   uint8_t bits(void) const
+   {
+      return this->input_ == input::t0 ? 8 : 16;
+   }
+
+   /********************************************************************************
+   * hardware_count: Returnerar aktuellt vrde p timerkretsens rknare.
+   ********************************************************************************/
+   uint16_t hardware_count(void) const
+   {
+      return this->input_ == input::t0 ? TCNT0 : TCNT1;
+   }
+
+   /********************************************************************************
+   * arm_compare: Aktiverar compare match B fr trskelvrdets lgre bitar.
+   ********************************************************************************/
+   void arm_compare(void)
+   {
+      if (this->input_ == input::t0)
+      {
+         OCR0B = static_cast<uint8_t>(this->threshold_);
+         TIFR0 = (1 << OCF0B);
+         TIMSK0 |= (1 << OCIE0B);
+      }
+      else
+      {
+         OCR1B = static_cast<uint16_t>(this->threshold_);
+         TIFR1 = (1 << OCF1B);
+         TIMSK1 |= (1 << OCIE1B);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * disarm_compare: Inaktiverar compare match B.
+   ********************************************************************************/
+   void disarm_compare(void)
+   {
+      if (this->input_ == input::t0)
+      {
+         TIMSK0 &= ~(1 << OCIE0B);
+      }
+      else
+      {
+         TIMSK1 &= ~(1 << OCIE1B);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * reached: Anropas nr trskelvrdet har uppntts. Trskelvrdet
+   *          inaktiveras, varefter callbackrutinen anropas.
+   ********************************************************************************/
+   void reached(void)
+   {
+      this->threshold_armed_ = false;
+      this->disarm_compare();
+      if (this->callback_) this->callback_();
+      return;
+   }
+
+   /********************************************************************************
+   * check_threshold: Aktiverar compare match ifall rknarens vre bitar
+   *                  verensstmmer med trskelvrdet, alternativt anropar
+   *                  reached direkt ifall trskelvrdet redan har uppntts.
+   *                  Avbrott mste vara inaktiverade vid anrop.
+   *
+   *                  - count: Aktuellt vrde p rknaren.
+   ********************************************************************************/
+   void check_threshold(const uint32_t count)
+   {
+      if (!this->threshold_armed_) return;
+
+      if (count >= this->threshold_)
+      {
+         this->reached();
+      }
+      else if ((count >> this->bits()) == (this->threshold_ >> this->bits()))
+      {
+         this->arm_compare();
+         if (this->read_unlocked() >= this->threshold_) this->reached();
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * read_unlocked: Returnerar rknarens vrde. Ifall en overflow har skett
+   *                men nnu inte behandlats rknas den med. Avbrott mste
+   *                vara inaktiverade vid anrop.
+   ********************************************************************************/
+   uint32_t read_unlocked(void) const
+   {
+      uint32_t overflows = this->overflows_;
+      const uint16_t count = this->hardware_count();
+      const bool pending = this->input_ == input::t0 ? (TIFR0 & (1 << TOV0)) : (TIFR1 & (1 << TOV1));
+      if (pending && count < (1U << (this->bits() - 1))) overflows++;
+      return (overflows << this->bits()) | count;
+   }
+
+public:
+
+   /********************************************************************************
+   * event_counter: Reserverar timerkretsen fr angiven insignal och startar
+   *                rkning av pulser. Ifall timerkretsen redan anvnds
+   *                startas ingen rkning, vilket kan kontrolleras via valid.
+   *
+   *                - input      : Insignal, T0 (pin 4) eller T1 (pin 5).
+   *                - count_edge : Flank som ska rknas (default = stigande).
+   ********************************************************************************/
+   event_counter(const input input,
+                 const edge count_edge = edge::rising)
+      : circuit_(timer::reservable(input == input::t0 ? timer::sel::timer0 : timer::sel::timer1), q16_16(0)),
+        input_(input)
+   {
+      const uint8_t index = static_cast<uint8_t>(input);
+      if (!this->circuit_.hardware() || instances_[index]) return;
+      const uint8_t clock = count_edge == edge::rising ? 0x07 : 0x06;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (input == input::t0)
+      {
+         DDRD &= ~(1 << 4);
+         TCCR0A = 0;
+         TCCR0B = clock;
+         TCNT0 = 0;
+         TIFR0 = (1 << TOV0);
+         TIMSK0 |= (1 << TOIE0);
+      }
+      else
+      {
+         DDRD &= ~(1 << 5);
+         TCCR1A = 0;
+         TCCR1B = clock;
+         TCNT1 = 0;
+         TIFR1 = (1 << TOV1);
+         TIMSK1 |= (1 << TOIE1);
+      }
+
+      instances_[index] = this;
+      this->valid_ = true;
+      SREG = sreg;
+      asm("SEI");
+      return;
+   }
+
+   /********************************************************************************
+   * ~event_counter: Stoppar rkningen och frigr timerkretsen.
+   ********************************************************************************/
+   ~event_counter(void)
+   {
+      if (!this->valid_) return;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (this->input_ == input::t0)
+      {
+         TIMSK0 &= ~((1 << TOIE0) | (1 << OCIE0B));
+         TCCR0B = 0;
+      }
+      else
+      {
+         TIMSK1 &= ~((1 << TOIE1) | (1 << OCIE1B));
+         TCCR1B = 0;
+      }
+
+      instances_[static_cast<uint8_t>(this->input_)] = nullptr;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * valid: Indikerar ifall timerkretsen kunde reserveras och rkning pgr.
+   ********************************************************************************/
+   bool valid(void) const
+   {
+      return this->valid_;
+   }
+
+   /********************************************************************************
+   * read: Returnerar antalet rknade pulser sedan start eller senaste clear.
+   ********************************************************************************/
+   uint32_t read(void) const
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint32_t count = this->read_unlocked();
+      SREG = sreg;
+      return count;
+   }
+
+   /********************************************************************************
+   * clear: Nollstller rknaren. Ett aktivt trskelvrde kvarstr och gller
+   *        drefter rknat frn noll.
+   ********************************************************************************/
+   void clear(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (this->input_ == input::t0)
+      {
+         TCNT0 = 0;
+         TIFR0 = (1 << TOV0);
+      }
+      else
+      {
+         TCNT1 = 0;
+         TIFR1 = (1 << TOV1);
+      }
+
+      this->overflows_ = 0;
+      this->disarm_compare();
+      this->check_threshold(0);
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * set_threshold: Stter trskelvrde, dr angiven callbackrutin anropas
+   *                frn avbrottsrutinen en gng nr rknaren nr
+   *                trskelvrdet. Ifall rknaren redan har ntt trskel-
+   *                vrdet anropas callbackrutinen direkt.
+   *
+   *                - threshold   : Trskelvrde mtt i antalet pulser.
+   *                - new_callback: Callbackrutin vid uppntt trskelvrde.
+   ********************************************************************************/
+   void set_threshold(const uint32_t threshold,
+                      const callback new_callback)
+   {
+      if (!this->valid_) return;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->disarm_compare();
+      this->threshold_ = threshold;
+      this->callback_ = new_callback;
+      this->threshold_armed_ = true;
+      this->check_threshold(this->read_unlocked());
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * clear_threshold: Inaktiverar trskelvrdet.
+   ********************************************************************************/
+   void clear_threshold(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->threshold_armed_ = false;
+      this->disarm_compare();
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * on_overflow: Rknar upp antalet overflows fr rknaren p angiven
+   *              insignal. Ska anropas frn avbrottsrutinen fr
+   *              TIMER0_OVF_vect respektive TIMER1_OVF_vect.
+   *
+   *              - input: Insignalen vars timerkrets fick overflow.
+   ********************************************************************************/
+   static void on_overflow(const input input)
+   {
+      event_counter* counter = instances_[static_cast<uint8_t>(input)];
+      if (!counter) return;
+      counter->overflows_++;
+      counter->check_threshold(counter->read_unlocked());
+      return;
+   }
+
+   /********************************************************************************
+   * on_compare: Anropar callbackrutinen fr rknaren p angiven insignal nr
+   *             trskelvrdet har uppntts. Ska anropas frn avbrottsrutinen
+   *             fr TIMER0_COMPB_vect respektive TIMER1_COMPB_vect.
+   *
+   *             - input: Insignalen vars timerkrets fick compare match.
+   ********************************************************************************/
+   static void on_compare(const input input)
+   {
+      event_counter* counter = instances_[static_cast<uint8_t>(input)];
+      if (counter && counter->threshold_armed_) counter->reached();
+      return;
+   }
+
+   /********************************************************************************
+   * input: Enumeration fr val av insignal.
+   ********************************************************************************/
+   enum class input
+   {
+      t0, /* Pin T0 (pin 4), rknas av Timer 0. */
+      t1  /* Pin T1 (pin 5), rknas av Timer 1. */
+   };
+
+   /********************************************************************************
+   * edge: Enumeration fr val av flank som ska rknas.
+   ********************************************************************************/
+   enum class edge
+   {
+      rising, /* Stigande flank. */
+      falling /* Fallande flank. */
+   };
+};
+
+#endif /* EVENT_COUNTER_HPP_ */
\ No newline at end of file
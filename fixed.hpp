@@ -0,0 +1,194 @@
+/********************************************************************************
+* fixed.hpp: Innehller datatyper fr fixpunktsaritmetik (fixed point) via
+*            klassmallen fixed, vilket mjliggr berkningar med decimaltal
+*            utan flyttal. Flyttal av typen double r p AVR 32-bitars och
+*            implementeras helt i mjukvara, vilket kostar hundratals
+*            klockcykler per operation samt flera kilobyte programminne.
+*
+*            Ett fixpunktstal lagras som ett heltal, dr de F lgsta bitarna
+*            utgr brkdelen. Vrdet 1.5 i formatet Q8.8 lagras exempelvis
+*            som 1.5 * 2^8 = 384. Fljande format r frdefinierade:
+*
+*            Format     Datatyp     Intervall                  Upplsning
+*            Q8.8       q8_8        -128 - 127.996              1 / 256
+*            Q16.16     q16_16      -32 768 - 32 767.99998      1 / 65 536
+*
+*            Samtliga rkneoperationer mttas vid ver- eller underflde,
+*            dvs. resultatet begrnsas till hgsta respektive lgsta
+*            mjliga vrde i stllet fr att sl runt. Multiplikation och
+*            division avrundas till nrmaste representerbara vrde.
+********************************************************************************/
+#ifndef FIXED_HPP_
+#define FIXED_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* fixed: Klassmall fr fixpunktstal, dr T utgr datatypen fr lagring, W
+*        utgr en dubbelt s bred datatyp fr mellanresultat och F utgr
+*        antalet brkbitar.
+********************************************************************************/
+template<class T, class W, uint8_t F>
+class fixed
+{
+private:
+   T raw_ = 0; /* Lagrat vrde, skalat med 2^F. */
+
+   static constexpr W MAX_ = (static_cast<W>(1) << (sizeof(T) * 8 - 1)) - 1; /* Hgsta vrde. */
+   static constexpr W MIN_ = -MAX_ - 1;                                       /* Lgsta vrde. */
+
+   /********************************************************************************
+   * saturate: Begrnsar angivet mellanresultat till lagringstypens intervall.
+   *
+   *           - value: Mellanresultatet som ska begrnsas.
+   ********************************************************************************/
+   static constexpr T saturate(const W value)
+   {
+      return static_cast<T>(value > MAX_ ? MAX_ : (value < MIN_ ? MIN_ : value));
+   }
+
+public:
+   static constexpr uint8_t FRACTION_BITS = F; /* Antalet brkbitar. */
+
+   /********************************************************************************
+   * fixed: Initierar nytt fixpunktstal med vrdet noll.
+   ********************************************************************************/
+   constexpr fixed(void) { }
+
+   /********************************************************************************
+   * fixed: Initierar nytt fixpunktstal frn ett heltal av godtycklig heltalstyp.
+   *        Flyttal avvisas vid kompilering, eftersom decimalerna annars skulle
+   *        trunkeras. Flyttalskonstanter omvandlas i stllet via from_double.
+   *
+   *        - integer: Heltalet som ska omvandlas.
+   ********************************************************************************/
+   template<class I>
+   constexpr fixed(const I integer)
+      : raw_(saturate(static_cast<W>(integer) * (static_cast<W>(1) << F)))
+   {
+      static_assert(static_cast<I>(1) / static_cast<I>(2) == 0,
+                    "Flyttal mste omvandlas via from_double!");
+   }
+
+   /********************************************************************************
+   * from_raw: Returnerar ett fixpunktstal med angivet lagrat vrde.
+   *
+   *           - raw: Lagrat vrde, dvs. det nskade vrdet multiplicerat
+   *                  med 2^F.
+   ********************************************************************************/
+   static constexpr fixed from_raw(const T raw)
+   {
+      fixed result;
+      result.raw_ = raw;
+      return result;
+   }
+
+   /********************************************************************************
+   * from_ratio: Returnerar kvoten mellan tv heltal som ett fixpunktstal,
+   *             avrundat till nrmaste representerbara vrde.
+   *
+   *             - numerator  : Tljaren.
+   *             - denominator: Nmnaren (fr inte vara noll).
+   ********************************************************************************/
+   static constexpr fixed from_ratio(const W numerator,
+                                     const W denominator)
+   {
+      const W scaled = numerator * (static_cast<W>(1) << F);
+      const W n = denominator < 0 ? -scaled : scaled;
+      const W d = denominator < 0 ? -denominator : denominator;
+      return from_raw(saturate((n < 0 ? n - d / 2 : n + d / 2) / d));
+   }
+
+   /********************************************************************************
+   * from_double: Returnerar ett fixpunktstal frn ett flyttal. r endast
+   *              avsedd fr konstanter som berknas vid kompilering (via
+   *              constexpr), s att flyttalsrutiner inte lnkas in.
+   *
+   *              - value: Flyttalet som ska omvandlas.
+   ********************************************************************************/
+   static constexpr fixed from_double(const double value)
+   {
+      return from_raw(saturate(static_cast<W>(value * (static_cast<W>(1) << F) +
+                                              (value < 0 ? -0.5 : 0.5))));
+   }
+
+   /********************************************************************************
+   * raw: Returnerar lagrat vrde, dvs. vrdet multiplicerat med 2^F.
+   ********************************************************************************/
+   constexpr T raw(void) const
+   {
+      return this->raw_;
+   }
+
+   /********************************************************************************
+   * to_int: Returnerar vrdet avrundat till nrmaste heltal.
+   ********************************************************************************/
+   constexpr T to_int(void) const
+   {
+      return static_cast<T>((static_cast<W>(this->raw_) + (static_cast<W>(1) << (F - 1))) >> F);
+   }
+
+   /********************************************************************************
+   * scale: Multiplicerar vrdet med angivet heltal och returnerar resultatet
+   *        avrundat till nrmaste heltal, exempelvis fr att berkna en andel
+   *        av en period.
+   *
+   *        - factor: Heltalet som vrdet ska multipliceras med.
+   ********************************************************************************/
+   constexpr W scale(const W factor) const
+   {
+      return (static_cast<W>(this->raw_) * factor + (static_cast<W>(1) << (F - 1))) >> F;
+   }
+
+   /********************************************************************************
+   * Aritmetiska operatorer med mttning samt avrundning.
+   ********************************************************************************/
+   constexpr fixed operator+(const fixed other) const
+   {
+      return from_raw(saturate(static_cast<W>(this->raw_) + other.raw_));
+   }
+
+   constexpr fixed operator-(const fixed other) const
+   {
+      return from_raw(saturate(static_cast<W>(this->raw_) - other.raw_));
+   }
+
+   constexpr fixed operator-(void) const
+   {
+      return from_raw(saturate(-static_cast<W>(this->raw_)));
+   }
+
+   constexpr fixed operator*(const fixed other) const
+   {
+      return from_raw(saturate((static_cast<W>(this->raw_) * other.raw_ +
+                                (static_cast<W>(1) << (F - 1))) >> F));
+   }
+
+   constexpr fixed operator/(const fixed other) const
+   {
+      return other.raw_ == 0 ? from_raw(this->raw_ < 0 ? static_cast<T>(MIN_) : static_cast<T>(MAX_)) :
+                               from_ratio(this->raw_, other.raw_);
+   }
+
+   fixed& operator+=(const fixed other) { return *this = *this + other; }
+   fixed& operator-=(const fixed other) { return *this = *this - other; }
+   fixed& operator*=(const fixed other) { return *this = *this * other; }
+   fixed& operator/=(const fixed other) { return *this = *this / other; }
+
+   /********************************************************************************
+   * Jmfrelseoperatorer.
+   ********************************************************************************/
+   constexpr bool operator==(const fixed other) const { return this->raw_ == other.raw_; }
+   constexpr bool operator!=(const fixed other) const { return this->raw_ != other.raw_; }
+   constexpr bool operator<(const fixed other) const { return this->raw_ < other.raw_; }
+   constexpr bool operator>(const fixed other) const { return this->raw_ > other.raw_; }
+   constexpr bool operator<=(const fixed other) const { return this->raw_ <= other.raw_; }
+   constexpr bool operator>=(const fixed other) const { return this->raw_ >= other.raw_; }
+};
+
+/* Frdefinierade fixpunktsformat: */
+typedef fixed<int16_t, int32_t, 8> q8_8;    /* Q8.8, 16 bitar med 8 brkbitar. */
+typedef fixed<int32_t, int64_t, 16> q16_16; /* Q16.16, 32 bitar med 16 brkbitar. */
+
+#endif /* FIXED_HPP_ */
\ No newline at end of file
@@ -0,0 +1,262 @@
+/********************************************************************************
+* frequency_generator.hpp: Innehller funktionalitet fr generering av
+*                          fyrkantsvgor via klassen frequency_generator.
+*                          Timerkretsen krs i CTC Mode med togglande
+*                          utsignal (Toggle OCnA on Compare Match), vilket
+*                          gr att utsignalen p timerkretsens OC-pin
+*                          togglas direkt av hrdvaran utan ngra avbrott.
+*
+*                          Vid start vljs minsta prescaler som ger ett
+*                          compare-vrde inom timerkretsens rknare, vilket
+*                          ger bst upplsning. Faktiskt erhllen frekvens
+*                          kan lsas av efter start, d denna kan avvika
+*                          ngot frn begrd frekvens:
+*
+*                          f = F_CPU / (2 * N * (1 + OCRnA)),
+*
+*                          dr N utgr prescalern.
+*
+*                          Timerkretsen reserveras via klassen timer och kan
+*                          drmed inte anvndas av ngot timer-objekt
+*                          samtidigt. Timer 2 kan inte anvndas medan den
+*                          delade ticken i klassen timer r startad. Omvnt
+*                          kan den delade ticken, och drmed mjukvarutimrar
+*                          samt tidsstmplar, inte startas medan Timer 2
+*                          genererar en vg.
+*
+*                          Timerkrets     Utsignal (Arduino Uno)     Frekvens
+*                           Timer 0        pin 6 (PORTD6 / OC0A)     31 Hz - 8 MHz
+*                           Timer 1        pin 9 (PORTB1 / OC1A)      1 Hz - 8 MHz
+*                           Timer 2        pin 11 (PORTB3 / OC2A)    31 Hz - 8 MHz
+********************************************************************************/
+#ifndef FREQUENCY_GENERATOR_HPP_
+#define FREQUENCY_GENERATOR_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+
+/********************************************************************************
+* frequency_generator: Klass fr generering av fyrkantsvgor p en
+*                      timerkrets OC-pin utan avbrott.
+********************************************************************************/
+class frequency_generator
+{
+private:
+   /********************************************************************************
+   * prescaler_t: Strukt fr en prescaler samt motsvarande CS-bitar.
+   ********************************************************************************/
+   struct prescaler_t
+   {
+      uint16_t divisor; /* Division av systemklockan. */
+      uint8_t cs;       /* Motsvarande vrde p CS-bitarna i TCCRnB. */
+   };
+
+   /* Tillgngliga prescalers fr Timer 0 samt Timer 1: */
+   static constexpr prescaler_t PRESCALERS_[] =
+   {
+      { 1, 0x01 }, { 8, 0x02 }, { 64, 0x03 }, { 256, 0x04 }, { 1024, 0x05 }
+   };
+
+   /* Tillgngliga prescalers fr Timer 2: */
+   static constexpr prescaler_t PRESCALERS_TIMER2_[] =
+   {
+      { 1, 0x01 }, { 8, 0x02 }, { 32, 0x03 }, { 64, 0x04 },
+      { 128, 0x05 }, { 256, 0x06 }, { 1024, 0x07 }
+   };
+
+   basic_timer<uint8_t> circuit_; /* Reservation av timerkretsen. */
+   timer::sel timer_sel_;         /* Begrd timerkrets. */
+   uint32_t frequency_hz_ = 0;    /* Erhllen frekvens, avrundad till heltal. */
+   uint32_t half_period_ = 0;     /* Halv period mtt i klockcykler. */
+   bool running_ = false;         /* Indikerar ifall en vg genereras. */
+
+   /********************************************************************************
+   * find: Letar upp minsta prescaler som ger ett compare-vrde mellan
+   *       1 - max_count. Vid lyckad skning returneras 0, annars felkod 1.
+   *
+   *       - frequency_hz: Begrd frekvens mtt i Hz.
+   *       - prescalers  : Pekare till tabell med tillgngliga prescalers.
+   *       - size        : Antalet prescalers i tabellen.
+   *       - max_count   : Strsta vrde p timerkretsens rknare + 1.
+   *       - prescaler   : Referens till variabel dr vald prescaler lagras.
+   *       - counts      : Referens till variabel dr OCRnA + 1 lagras.
+   ********************************************************************************/
+   static int find(const uint32_t frequency_hz,
+                   const prescaler_t* prescalers,
+                   const uint8_t size,
+                   const uint32_t max_count,
+                   prescaler_t& prescaler,
+                   uint32_t& counts)
+   {
+      for (uint8_t i = 0; i < size; ++i)
+      {
+         const uint32_t clock = F_CPU / prescalers[i].divisor;
+         counts = (clock + frequency_hz) / (2 * frequency_hz);
+
+         if (counts >= 1 && counts <= max_count)
+         {
+            prescaler = prescalers[i];
+            return 0;
+         }
+      }
+
+      return 1;
+   }
+
+public:
+
+   /********************************************************************************
+   * frequency_generator: Reserverar angiven timerkrets fr generering av
+   *                      fyrkantsvgor. Ifall timerkretsen redan anvnds
+   *                      misslyckas efterfljande anrop av start.
+   *
+   *                      - timer_sel: Timerkretsen som ska anvndas.
+   ********************************************************************************/
+   frequency_generator(const timer::sel timer_sel)
+      : circuit_(timer::reservable(timer_sel), q16_16(0)), timer_sel_(timer_sel) { }
+
+   /********************************************************************************
+   * ~frequency_generator: Stoppar genereringen och frigr timerkretsen.
+   ********************************************************************************/
+   ~frequency_generator(void)
+   {
+      this->stop();
+      return;
+   }
+
+   /********************************************************************************
+   * start: Startar generering av en fyrkantsvg med angiven frekvens p
+   *        timerkretsens OC-pin. Vid lyckad start returneras 0. Ifall
+   *        timerkretsen inte kunde reserveras eller frekvensen ligger
+   *        utanfr timerkretsens omrde returneras felkod 1.
+   *
+   *        - frequency_hz: Begrd frekvens mtt i Hz.
+   ********************************************************************************/
+   int start(const uint32_t frequency_hz)
+   {
+      if (!frequency_hz || frequency_hz > F_CPU / 2 || !this->circuit_.hardware()) return 1;
+
+      prescaler_t prescaler;
+      uint32_t counts;
+      int result;
+
+      if (this->timer_sel_ == timer::sel::timer1)
+      {
+         result = find(frequency_hz, PRESCALERS_, 5, 65536, prescaler, counts);
+      }
+      else if (this->timer_sel_ == timer::sel::timer2)
+      {
+         result = find(frequency_hz, PRESCALERS_TIMER2_, 7, 256, prescaler, counts);
+      }
+      else
+      {
+         result = find(frequency_hz, PRESCALERS_, 5, 256, prescaler, counts);
+      }
+
+      if (result) return 1;
+      if (this->timer_sel_ == timer::sel::timer2 && timer::block_shared_tick()) return 1;
+
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (this->timer_sel_ == timer::sel::timer0)
+      {
+         TIMSK0 &= ~((1 << TOIE0) | (1 << OCIE0A));
+         TCCR0A = (1 << COM0A0) | (1 << WGM01);
+         TCCR0B = prescaler.cs;
+         OCR0A = static_cast<uint8_t>(counts - 1);
+         TCNT0 = 0;
+         DDRD |= (1 << 6);
+      }
+      else if (this->timer_sel_ == timer::sel::timer1)
+      {
+         TIMSK1 &= ~((1 << TOIE1) | (1 << OCIE1A));
+         TCCR1A = (1 << COM1A0);
+         TCCR1B = (1 << WGM12) | prescaler.cs;
+         OCR1A = static_cast<uint16_t>(counts - 1);
+         TCNT1 = 0;
+         DDRB |= (1 << 1);
+      }
+      else
+      {
+         TIMSK2 &= ~((1 << TOIE2) | (1 << OCIE2A));
+         TCCR2A = (1 << COM2A0) | (1 << WGM21);
+         TCCR2B = prescaler.cs;
+         OCR2A = static_cast<uint8_t>(counts - 1);
+         TCNT2 = 0;
+         DDRB |= (1 << 3);
+      }
+
+      SREG = sreg;
+      const uint32_t clock = F_CPU / prescaler.divisor;
+      this->frequency_hz_ = (clock + counts) / (2 * counts);
+      this->half_period_ = counts * prescaler.divisor;
+      this->running_ = true;
+      return 0;
+   }
+
+   /********************************************************************************
+   * stop: Stoppar genereringen. OC-pinnen kopplas bort frn timerkretsen
+   *       och stts lg.
+   ********************************************************************************/
+   void stop(void)
+   {
+      if (!this->running_) return;
+
+      if (this->timer_sel_ == timer::sel::timer0)
+      {
+         TCCR0A = 0;
+         TCCR0B = 0;
+         PORTD &= ~(1 << 6);
+      }
+      else if (this->timer_sel_ == timer::sel::timer1)
+      {
+         TCCR1A = 0;
+         TCCR1B = 0;
+         PORTB &= ~(1 << 1);
+      }
+      else
+      {
+         TCCR2A = 0;
+         TCCR2B = 0;
+         PORTB &= ~(1 << 3);
+         timer::unblock_shared_tick();
+      }
+
+      this->frequency_hz_ = 0;
+      this->half_period_ = 0;
+      this->running_ = false;
+      return;
+   }
+
+   /********************************************************************************
+   * running: Indikerar ifall en fyrkantsvg genereras.
+   ********************************************************************************/
+   bool running(void) const
+   {
+      return this->running_;
+   }
+
+   /********************************************************************************
+   * frequency: Returnerar erhllen frekvens mtt i Hz, avrundad till
+   *            nrmaste heltal, alternativt 0 ifall ingen vg genereras.
+   ********************************************************************************/
+   uint32_t frequency(void) const
+   {
+      return this->frequency_hz_;
+   }
+
+   /********************************************************************************
+   * half_period_cycles: Returnerar exakt tid mellan varje toggling av
+   *                     utsignalen mtt i klockcykler, vilket kan anvndas
+   *                     fr att berkna erhllen frekvens med full
+   *                     precision: f = F_CPU / (2 * half_period_cycles).
+   ********************************************************************************/
+   uint32_t half_period_cycles(void) const
+   {
+      return this->half_period_;
+   }
+};
+
+#endif /* FREQUENCY_GENERATOR_HPP_ */
\ No newline at end of file
@@ -8,16 +8,53 @@
 /* Inkluderingsdirektiv: */
 #include "led.hpp"
 #include "button.hpp"
+#include "button_event.hpp"
 #include "timer.hpp"
+#include "pcint.hpp"
+#include "adc.hpp"
+#include "adc_scan.hpp"
+#include "adc_pwm.hpp"
+#include "serial.hpp"
+#include "trace.hpp"
+#include "memory.hpp"
+#include "event_counter.hpp"
+#include "cpu_load.hpp"
+#include "isr_policy.hpp"
 
 /* Deklaration av globala objekt: */
 extern led l1, l2;       /* Lysdioder. */
-extern button b1, b2;    /* Tryckknappar. */
-extern timer t0, t1, t2; /* Timerkretsar. */
+extern button b1, b2;    /* Tryckknappar. */
+extern button_event_queue button_events;      /* K med tryckknappsevent. */
+extern button_event_detector d1, d2;          /* Detektorer fr tryckknapparna. */
+extern timer_for<100> t1, t2; /* Timerkretsar fr blinkning. */
 
 /********************************************************************************
 * setup: Initierar det inbyggda systemet.
 ********************************************************************************/
 void setup(void);
 
+/********************************************************************************
+* b1_changed: Hanterare fr avstudsade event p tryckknapp 1.
+*
+*             - pressed: Indikerar ifall tryckknappen r nedtryckt.
+********************************************************************************/
+void b1_changed(const bool pressed);
+
+/********************************************************************************
+* b2_changed: Hanterare fr avstudsade event p tryckknapp 2.
+*
+*             - pressed: Indikerar ifall tryckknappen r nedtryckt.
+********************************************************************************/
+void b2_changed(const bool pressed);
+
+/********************************************************************************
+* t1_elapsed: Callbackrutin fr timer 1, togglar lysdiod 1.
+********************************************************************************/
+void t1_elapsed(void);
+
+/********************************************************************************
+* t2_elapsed: Callbackrutin fr timer 2, togglar lysdiod 2.
+********************************************************************************/
+void t2_elapsed(void);
+
 #endif /* HEADER_HPP_ */
\ No newline at end of file
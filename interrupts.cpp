@@ -4,106 +4,310 @@
 #include "header.hpp"
 
 /********************************************************************************
-* ISR (PCINT0_vect): Avbrottsrutin som ger rum vid nedtryckning/uppslppning
-*                    av ngon av tryckknapparna. Beroende p vilken tryckknapp
-*                    som trycks ned s togglas antingen timer 1 eller timer 2.
-*                    Vid uppslppning av en tryckknapp grs ingenting.
+* b1_changed: Hanterare som anropas frn huvudprogrammet vid avstudsad
+*             nedtryckning/uppslppning av tryckknapp 1. Vid nedtryckning
+*             togglas timer 1, vid uppslppning grs ingenting.
 *
-*                    Oavsett vad som orsakade avbrottet inaktiveras PCI-avbrott
-*                    p I/O-port B i 300 millisekunder via timer 0 fr att
-*                    undvika multipla avbrott orsakade av kontaktstudsar.
+*             - pressed: Indikerar ifall tryckknappen r nedtryckt.
 ********************************************************************************/
-ISR (PCINT0_vect)
+void b1_changed(const bool pressed)
 {
-   misc::disable_pin_change_interrupt(io_port::b);
-   t0.enable_interrupt();
+   trace::record(pressed ? trace::event::button_press : trace::event::button_release, b1.pin());
 
-   if (b1.is_pressed())
+   if (pressed)
    {
       t1.toggle_interrupt();
       if (!t1.interrupt_enabled())
       {
          l1.off();
+         trace::record(trace::event::timer_disable, 1);
+      }
+      else
+      {
+         trace::record(trace::event::timer_enable, 1);
       }
    }
-   else if (b2.is_pressed())
+
+   return;
+}
+
+/********************************************************************************
+* b2_changed: Hanterare som anropas frn huvudprogrammet vid avstudsad
+*             nedtryckning/uppslppning av tryckknapp 2. Vid nedtryckning
+*             togglas timer 2, vid uppslppning grs ingenting.
+*
+*             - pressed: Indikerar ifall tryckknappen r nedtryckt.
+********************************************************************************/
+void b2_changed(const bool pressed)
+{
+   trace::record(pressed ? trace::event::button_press : trace::event::button_release, b2.pin());
+
+   if (pressed)
    {
       t2.toggle_interrupt();
       if (!t2.interrupt_enabled())
       {
          l2.off();
+         trace::record(trace::event::timer_disable, 2);
+      }
+      else
+      {
+         trace::record(trace::event::timer_enable, 2);
       }
    }
 
    return;
 }
 
+/********************************************************************************
+* t1_elapsed: Callbackrutin som anropas nr timer 1 lper ut, vilket medfr
+*             att lysdiod 1 togglas.
+********************************************************************************/
+void t1_elapsed(void)
+{
+   l1.toggle();
+   trace::record(l1.enabled() ? trace::event::led_on : trace::event::led_off, l1.pin());
+   return;
+}
+
+/********************************************************************************
+* t2_elapsed: Callbackrutin som anropas nr timer 2 lper ut, vilket medfr
+*             att lysdiod 2 togglas.
+********************************************************************************/
+void t2_elapsed(void)
+{
+   l2.toggle();
+   trace::record(l2.enabled() ? trace::event::led_on : trace::event::led_off, l2.pin());
+   return;
+}
+
+/********************************************************************************
+* pcint0_handler: Hanterare fr PCI-avbrott p I/O-port B. Endast ndrade
+*                 pinnar behandlas, dr registrerad hanterare anropas fr
+*                 varje sdan pin.
+********************************************************************************/
+static void pcint0_handler(void)
+{
+   trace::record(trace::event::pcint, static_cast<uint8_t>(io_port::b));
+   pcint::dispatch(io_port::b);
+   return;
+}
+
+/********************************************************************************
+* pcint1_handler: Hanterare fr PCI-avbrott p I/O-port C.
+********************************************************************************/
+static void pcint1_handler(void)
+{
+   pcint::dispatch(io_port::c);
+   return;
+}
+
+/********************************************************************************
+* pcint2_handler: Hanterare fr PCI-avbrott p I/O-port D.
+********************************************************************************/
+static void pcint2_handler(void)
+{
+   pcint::dispatch(io_port::d);
+   return;
+}
+
+/********************************************************************************
+* timer0_handler: Hanterare fr overflow av timer 0. Timern som ger
+*                 timerkretsen rknas upp. Ifall Timer 0 i stllet rknar
+*                 externa pulser rknas antalet overflows upp.
+********************************************************************************/
+static void timer0_handler(void)
+{
+   timer::on_interrupt(timer::sel::timer0);
+   event_counter::on_overflow(event_counter::input::t0);
+   return;
+}
+
+/********************************************************************************
+* timer1_handler: Hanterare fr compare match A p timer 1. Timern som ger
+*                 timerkretsen rknas upp.
+********************************************************************************/
+static void timer1_handler(void)
+{
+   timer::on_interrupt(timer::sel::timer1);
+   return;
+}
+
+/********************************************************************************
+* timer2_handler: Hanterare fr overflow av timer 2. Timern som ger
+*                 timerkretsen rknas upp.
+********************************************************************************/
+static void timer2_handler(void)
+{
+   timer::on_interrupt(timer::sel::timer2);
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT0_vect): Avbrottsrutin som ger rum vid ndring p ngon av de
+*                    aktiverade pinnarna p I/O-port B. Hanteraren exekveras
+*                    enligt vektorns avbrottspolicy (se setup).
+********************************************************************************/
+ISR (PCINT0_vect)
+{
+   isr_policy::run(isr_policy::vector::pcint0, pcint0_handler);
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT1_vect): Avbrottsrutin som ger rum vid ndring p ngon av de
+*                    aktiverade pinnarna p I/O-port C.
+********************************************************************************/
+ISR (PCINT1_vect)
+{
+   isr_policy::run(isr_policy::vector::pcint1, pcint1_handler);
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT2_vect): Avbrottsrutin som ger rum vid ndring p ngon av de
+*                    aktiverade pinnarna p I/O-port D.
+********************************************************************************/
+ISR (PCINT2_vect)
+{
+   isr_policy::run(isr_policy::vector::pcint2, pcint2_handler);
+   return;
+}
+
 /********************************************************************************
 * ISR (TIMER0_OVF_vect): Avbrottsrutin som ger rum vid overflow av timer 0,
 *                        dvs. upprkning till 256, vilket sker var 0.128:e
-*                        millisekund nr timern r aktiverad.
-*
-*                        Timern rknas upp via upprkning av varje passerat
-*                        avbrott. Nr timern lper ut (nr berknat antal
-*                        avbrott fr specificerad tid har rknats upp) s
-*                        teraktiveras PCI-avbrott p I/O-port B (som har)
-*                        stngts av i 300 millisekunder fr att undvika
-*                        multipla avbrott orsakat av kontaktstudsar), fljt
-*                        av att timern stngs av.
-********************************************************************************/
-ISR (TIMER0_OVF_vect)
+*                        millisekund nr timern r aktiverad. Timern som ger
+*                        timerkretsen rknas upp. Ifall Timer 0 i stllet
+*                        rknar externa pulser rknas antalet overflows upp.
+********************************************************************************/
+ISR (TIMER0_OVF_vect)
+{
+   isr_policy::run(isr_policy::vector::timer0_ovf, timer0_handler);
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER0_COMPB_vect): Avbrottsrutin som ger rum nr pulsrknaren p
+*                          pin T0 nr sitt trskelvrde.
+********************************************************************************/
+ISR (TIMER0_COMPB_vect)
+{
+   event_counter::on_compare(event_counter::input::t0);
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER1_COMPA_vect): Avbrottsrutin som ger rum efter 256 steg (0 - 255)
+*                          p timer 1 i CTC Mode, vilket sker var 0.128:e
+*                          millisekund nr timern r aktiverad. Timern som
+*                          ger timerkretsen rknas upp.
+********************************************************************************/
+ISR (TIMER1_COMPA_vect)
+{
+   isr_policy::run(isr_policy::vector::timer1_compa, timer1_handler);
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER1_OVF_vect): Avbrottsrutin som ger rum vid overflow av timer 1
+*                        nr denna rknar externa pulser p pin T1. Antalet
+*                        overflows rknas upp.
+********************************************************************************/
+ISR (TIMER1_OVF_vect)
+{
+   event_counter::on_overflow(event_counter::input::t1);
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER1_COMPB_vect): Avbrottsrutin som ger rum nr pulsrknaren p
+*                          pin T1 nr sitt trskelvrde.
+********************************************************************************/
+ISR (TIMER1_COMPB_vect)
+{
+   event_counter::on_compare(event_counter::input::t1);
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER2_OVF_vect): Avbrottsrutin som ger rum vid overflow av timer 2,
+*                        dvs. upprkning till 256, vilket sker var 0.128:e
+*                        millisekund nr timern r aktiverad. Timern som ger
+*                        timerkretsen rknas upp.
+********************************************************************************/
+ISR (TIMER2_OVF_vect)
+{
+   isr_policy::run(isr_policy::vector::timer2_ovf, timer2_handler);
+   return;
+}
+
+/********************************************************************************
+* ISR (ADC_vect): Avbrottsrutin som ger rum nr en asynkron AD-omvandling r
+*                 slutfrd. Vid timerstyrd avlsning av flera kanaler lagras
+*                 resultatet fr aktuell kanal. Vid sluten styrning av en
+*                 PWM-utsignal uppdateras utsignalen, annars lagras
+*                 resultatet i AD-omvandlarens ringbuffert.
+********************************************************************************/
+ISR (ADC_vect)
 {
-   t0.count();
-
-   if (t0.elapsed())
+   if (adc_scan::active())
+   {
+      adc_scan::on_conversion_complete();
+   }
+   else if (adc_pwm::active())
    {
-      misc::enable_pin_change_interrupt(io_port::b);
-      t0.disable_interrupt();
+      adc_pwm::on_conversion_complete();
+   }
+   else
+   {
+      adc::on_conversion_complete();
    }
 
    return;
 }
 
-/********************************************************************************
-* ISR (TIMER1_COMPA_vect): Avbrottsrutin som ger rum vid upprkning till 256 av
-*                          timer 1 i CTC Mode, vilket sker var 0.128:e
-*                          millisekund nr timern r aktiverad.
-*
-*                          Timern rknas upp via upprkning av varje passerat
-*                          avbrott. Nr timern lper ut (nr berknat antal
-*                          avbrott fr specificerad tid har rknats upp) s
-*                          togglas lysdiod 1.
+/********************************************************************************
+* ISR (USART_UDRE_vect): Avbrottsrutin som ger rum nr USART0:s dataregister
+*                        r tomt, vilket sker nr nsta tecken kan skickas.
+*                        Nsta tecken i sndningsbufferten skickas.
 ********************************************************************************/
-ISR (TIMER1_COMPA_vect)
+ISR (USART_UDRE_vect)
 {
-   t1.count();
-
-   if (t1.elapsed())
-   {
-      l1.toggle();
-   }
-
+   serial::on_data_register_empty();
    return;
 }
 
-/********************************************************************************
-* ISR (TIMER2_OVF_vect): Avbrottsrutin som ger rum vid overflow av timer 2,
-*                        dvs. upprkning till 256, vilket sker var 0.128:e
-*                        millisekund nr timern r aktiverad.
-*
-*                        Timern rknas upp via upprkning av varje passerat
-*                        avbrott. Nr timern lper ut (nr berknat antal
-*                        avbrott fr specificerad tid har rknats upp) s
-*                        togglas lysdiod 2.
+/********************************************************************************
+* ISR (USART_RX_vect): Avbrottsrutin som ger rum nr ett tecken har tagits
+*                      emot via USART0. Tecknet lagras i mottagningsbufferten.
 ********************************************************************************/
-ISR (TIMER2_OVF_vect)
+ISR (USART_RX_vect)
 {
-   t2.count();
+   serial::on_receive();
+   return;
+}
 
-   if (t2.elapsed())
-   {
-      l2.toggle();
-   }
+/********************************************************************************
+* timer2_compa_handler: Hanterare fr compare match A p timer 2. Den delade
+*                       ticken samt samtliga aktiverade mjukvarutimrar rknas
+*                       upp, varefter samtliga tryckknappsdetektorer
+*                       uppdateras.
+********************************************************************************/
+static void timer2_compa_handler(void)
+{
+   timer::on_shared_tick();
+   button_event_detector::on_shared_tick();
+   return;
+}
 
+/********************************************************************************
+* ISR (TIMER2_COMPA_vect): Avbrottsrutin som ger rum vid compare match A p
+*                          timer 2, vilket sker var 0.128:e millisekund nr
+*                          den delade ticken r startad.
+********************************************************************************/
+ISR (TIMER2_COMPA_vect)
+{
+   isr_policy::run(isr_policy::vector::timer2_compa, timer2_compa_handler);
    return;
 }
@@ -0,0 +1,303 @@
+/********************************************************************************
+* isr_policy.hpp: Innehller funktionalitet fr val av avbrottspolicy samt
+*                 vervakning av tidsbudgetar per avbrottsvektor via den
+*                 statiska klassen isr_policy.
+*
+*                 Som standard exekveras avbrottsrutiner med avbrott globalt
+*                 inaktiverade, vilket gr att en lngsam hanterare (exempelvis
+*                 vid PCI-avbrott) frdrjer timerkretsarnas tickar var
+*                 0.128:e millisekund. Avbrottsvektorer med policyn nested
+*                 exekverar i stllet sin hanterare med avbrott aktiverade
+*                 (motsvarande ISR_NOBLOCK), s att tidskritiska tickar kan
+*                 avbryta hanteraren. Ett terintrde i samma vektor medan
+*                 hanteraren exekverar utfrs inte direkt, utan registreras
+*                 och krs i stllet efter att hanteraren har slutfrts.
+*                 Drmed exekverar samma hanterare aldrig parallellt med sig
+*                 sjlv, samtidigt som inga avbrott gr frlorade.
+*
+*                 Fr varje avbrottsvektor mts hanterarens exekveringstid via
+*                 timer::timestamp. Ifall tiden verskrider vektorns tidsbudget
+*                 rknas antalet verskridanden upp. Tiden inkluderar
+*                 eventuella nstlade avbrott.
+*
+*                 Avbrottsrutinerna anropar run med aktuell vektor samt
+*                 hanteraren, exempelvis:
+*
+*                 ISR (PCINT0_vect)
+*                 {
+*                    isr_policy::run(isr_policy::vector::pcint0, pcint0_handler);
+*                    return;
+*                 }
+********************************************************************************/
+#ifndef ISR_POLICY_HPP_
+#define ISR_POLICY_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+#include "serial.hpp"
+
+/********************************************************************************
+* isr_policy: Statisk klass fr avbrottspolicy, skydd mot terintrde samt
+*             tidsbudgetar per avbrottsvektor.
+********************************************************************************/
+class isr_policy
+{
+public:
+   enum class vector : uint8_t; /* Frdeklaration av enumerationsklass fr avbrottsvektor. */
+   enum class policy; /* Frdeklaration av enumerationsklass fr avbrottspolicy. */
+   typedef void (*handler)(void); /* Hanterare, anropas frn avbrottsrutinen. */
+
+private:
+   /********************************************************************************
+   * stats_t: Strukt fr policy samt mtvrden fr en avbrottsvektor.
+   ********************************************************************************/
+   struct stats_t
+   {
+      uint16_t budget;   /* Tidsbudget i halva mikrosekunder (0 = ingen). */
+      uint16_t max;      /* Lngsta uppmtta tid i halva mikrosekunder. */
+      uint16_t overruns; /* Antal verskridanden av tidsbudgeten. */
+      uint8_t pending;   /* Antal terintrden som vntar p exekvering. */
+      uint8_t flags;     /* Policy samt aktivitet, se NESTED_ och ACTIVE_. */
+   };
+
+   static constexpr uint8_t NUM_VECTORS_ = 13;                     /* Antal avbrottsvektorer. */
+   static constexpr uint8_t NESTED_ = 0x01;                        /* Hanteraren exekverar med avbrott aktiverade. */
+   static constexpr uint8_t ACTIVE_ = 0x02;                        /* Hanteraren exekverar. */
+   static inline volatile stats_t stats_[NUM_VECTORS_] = { };      /* Policy samt mtvrden per vektor. */
+   static inline volatile uint16_t reentries_ = 0;                 /* Totalt antal terintrden. */
+
+   /********************************************************************************
+   * send_value: Placerar en rad p formen "label=value" i sndningsbufferten
+   *             fr USART0. Ifall raden inte fr plats vntas tills plats
+   *             finns, s att rapportens rader inte kastas. Vid lyckad
+   *             placering returneras 0, annars felkod 1.
+   *
+   *             - label: Pekare till nollterminerad benmning p vrdet.
+   *             - value: Vrdet som ska skickas.
+   ********************************************************************************/
+   static int send_value(const char* label,
+                         const uint32_t value)
+   {
+      const uint8_t capacity = serial::capacity();
+      uint8_t length = 13; /* Likhetstecken, hgst tio siffror samt radbrytning. */
+      for (const char* i = label; *i && length < capacity; ++i) length++;
+      if (length > capacity) length = capacity;
+      while (serial::free_space() < length);
+      return serial::print_value(label, value);
+   }
+
+public:
+
+   /********************************************************************************
+   * set_policy: Stter policy samt tidsbudget fr angiven avbrottsvektor.
+   *             Den delade ticken startas, eftersom denna anvnds fr
+   *             tidsmtningen. Vektorer fr USART0 har nivknsliga flaggor,
+   *             som kvarstr tills hanteraren har exekverat, och kan drmed
+   *             inte nstlas. Vid lyckad instllning returneras 0, annars
+   *             felkod 1, exempelvis ifall den delade ticken inte kan
+   *             startas eftersom Timer 2 r reserverad.
+   *
+   *             - isr_vector: Avbrottsvektorn som ska stllas in.
+   *             - new_policy: Ny policy fr avbrottsvektorn.
+   *             - budget_us : Tidsbudget i mikrosekunder (0 = ingen, max 32767).
+   ********************************************************************************/
+   static int set_policy(const vector isr_vector,
+                         const policy new_policy,
+                         const uint16_t budget_us = 0)
+   {
+      if (isr_vector == vector::usart_udre || isr_vector == vector::usart_rx)
+      {
+         if (new_policy == policy::nested) return 1;
+      }
+
+      if (budget_us > 32767) return 1;
+      if (timer::start_shared_tick()) return 1;
+
+      volatile stats_t& stats = stats_[static_cast<uint8_t>(isr_vector)];
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (new_policy == policy::nested)
+      {
+         stats.flags |= NESTED_;
+      }
+      else
+      {
+         stats.flags &= ~NESTED_;
+      }
+
+      stats.budget = budget_us << 1;
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * run: Exekverar angiven hanterare enligt avbrottsvektorns policy och
+   *      mter exekveringstiden. Ifall vektorn redan exekverar (vid nstlat
+   *      terintrde) registreras terintrdet och hanteraren krs i stllet
+   *      en extra gng nr pgende exekvering r slutfrd. Ska anropas frn
+   *      motsvarande avbrottsrutin.
+   *
+   *      - isr_vector: Aktuell avbrottsvektor.
+   *      - body      : Hanteraren som ska exekveras.
+   ********************************************************************************/
+   static void run(const vector isr_vector,
+                   const handler body)
+   {
+      volatile stats_t& stats = stats_[static_cast<uint8_t>(isr_vector)];
+
+      if (stats.flags & ACTIVE_)
+      {
+         if (stats.pending < 255) stats.pending++;
+         reentries_++;
+         return;
+      }
+
+      stats.flags |= ACTIVE_;
+      const bool nested = stats.flags & NESTED_;
+      uint32_t start = timer::timestamp();
+
+      /* Den delade ticken har intrffat men nnu inte rknats upp: */
+      if (isr_vector == vector::timer2_compa) start += 256;
+
+      if (nested) asm("SEI");
+
+      while (true)
+      {
+         body();
+         asm("CLI");
+         if (!stats.pending) break;
+         stats.pending--;
+         if (nested) asm("SEI");
+      }
+
+      stats.flags &= ~ACTIVE_;
+      const uint32_t duration = timer::timestamp() - start;
+      const uint16_t elapsed = duration > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(duration);
+
+      if (elapsed > stats.max) stats.max = elapsed;
+      if (stats.budget && elapsed > stats.budget && stats.overruns < 0xFFFF) stats.overruns++;
+      return;
+   }
+
+   /********************************************************************************
+   * max_us: Returnerar lngsta uppmtta exekveringstid fr angiven
+   *         avbrottsvektor i mikrosekunder.
+   *
+   *         - isr_vector: Aktuell avbrottsvektor.
+   ********************************************************************************/
+   static uint16_t max_us(const vector isr_vector)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t max = stats_[static_cast<uint8_t>(isr_vector)].max;
+      SREG = sreg;
+      return max >> 1;
+   }
+
+   /********************************************************************************
+   * overruns: Returnerar antalet verskridanden av tidsbudgeten fr angiven
+   *           avbrottsvektor.
+   *
+   *           - isr_vector: Aktuell avbrottsvektor.
+   ********************************************************************************/
+   static uint16_t overruns(const vector isr_vector)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t overruns = stats_[static_cast<uint8_t>(isr_vector)].overruns;
+      SREG = sreg;
+      return overruns;
+   }
+
+   /********************************************************************************
+   * reentries: Returnerar totalt antal terintrden som har skjutits upp
+   *            sedan start.
+   ********************************************************************************/
+   static uint16_t reentries(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t reentries = reentries_;
+      SREG = sreg;
+      return reentries;
+   }
+
+   /********************************************************************************
+   * clear: Nollstller samtliga mtvrden. Policy samt tidsbudgetar behlls.
+   ********************************************************************************/
+   static void clear(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      for (auto& i : stats_)
+      {
+         i.max = 0;
+         i.overruns = 0;
+      }
+
+      reentries_ = 0;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * report: Skickar mtvrden fr samtliga avbrottsvektorer som har exekverat
+   *         via USART0 som rader p formen "namn=vrde", dr varje vektor
+   *         inleds med sitt index i enumerationsklassen vector. Fre varje
+   *         rad vntas tills den fr plats i sndningsbufferten, varfr
+   *         funktionen ska anropas frn huvudprogrammet med avbrott
+   *         aktiverade. USART0 mste vara initierad via serial::init. Vid
+   *         lyckad verfring returneras 0, annars felkod 1.
+   ********************************************************************************/
+   static int report(void)
+   {
+      int result = 0;
+
+      for (uint8_t i = 0; i < NUM_VECTORS_; ++i)
+      {
+         const auto isr_vector = static_cast<vector>(i);
+         if (!max_us(isr_vector) && !overruns(isr_vector)) continue;
+         result |= send_value("isr", i);
+         result |= send_value("max_us", max_us(isr_vector));
+         result |= send_value("budget_us", stats_[i].budget >> 1);
+         result |= send_value("overruns", overruns(isr_vector));
+      }
+
+      result |= send_value("reentries", reentries());
+      return result;
+   }
+
+   /********************************************************************************
+   * vector: Enumeration fr avbrottsvektorer.
+   ********************************************************************************/
+   enum class vector : uint8_t
+   {
+      pcint0,       /* PCINT0_vect. */
+      pcint1,       /* PCINT1_vect. */
+      pcint2,       /* PCINT2_vect. */
+      timer0_ovf,   /* TIMER0_OVF_vect. */
+      timer0_compb, /* TIMER0_COMPB_vect. */
+      timer1_compa, /* TIMER1_COMPA_vect. */
+      timer1_ovf,   /* TIMER1_OVF_vect. */
+      timer1_compb, /* TIMER1_COMPB_vect. */
+      timer2_ovf,   /* TIMER2_OVF_vect. */
+      timer2_compa, /* TIMER2_COMPA_vect. */
+      adc,          /* ADC_vect. */
+      usart_udre,   /* USART_UDRE_vect. */
+      usart_rx      /* USART_RX_vect. */
+   };
+
+   /********************************************************************************
+   * policy: Enumeration fr avbrottspolicy.
+   ********************************************************************************/
+   enum class policy
+   {
+      blocking, /* Hanteraren exekverar med avbrott inaktiverade (standard). */
+      nested    /* Hanteraren exekverar med avbrott aktiverade (ISR_NOBLOCK). */
+   };
+};
+
+#endif /* ISR_POLICY_HPP_ */
\ No newline at end of file
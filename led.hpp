@@ -7,6 +7,7 @@
 
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
+#include "pin_map.hpp"
 
 /********************************************************************************
 * led: Klass fr implementering av lysdioder och andra digitala utportar.
@@ -31,28 +32,19 @@ public:
    led(const uint8_t pin,
        const uint8_t start_val = 0)
    {
-      if (pin >= 0 && pin <= 7)
-      {
-         this->io_port_ = io_port::d;
-         this->pin_ = pin;
-         DDRD |= (1 << this->pin_);
-      }
-      else if (pin >= 8 && pin <= 13)
+      pin_map::resolve(pin, this->io_port_, this->pin_);
+
+      if (this->io_port_ == io_port::b)
       {
-         this->io_port_ = io_port::b;
-         this->pin_ = pin - 8;
          DDRB |= (1 << this->pin_);
       }
-      else if (pin >= 14 && pin <= 19)
+      else if (this->io_port_ == io_port::c)
       {
-         this->io_port_ = io_port::c;
-         this->pin_ = pin - 14;
          DDRC |= (1 << this->pin_);
       }
-      else
+      else if (this->io_port_ == io_port::d)
       {
-         this->io_port_ = io_port::none;
-         this->pin_ = 0;
+         DDRD |= (1 << this->pin_);
       }
 
       this->enabled_ = false;
@@ -112,10 +104,15 @@ public:
    }
 
    /********************************************************************************
-   * on: Tnder angiven lysdiod.
+   * on: Tnder angiven lysdiod. I/O-porten uppdateras med avbrott
+   *     inaktiverade, s att nstlade avbrottsrutiner som skriver till samma
+   *     I/O-port inte strs.
    ********************************************************************************/
    void on(void)
    {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
       if (this->io_port_ == io_port::b)
       {
          PORTB |= (1 << this->pin_);
@@ -130,6 +127,7 @@ public:
       }
 
       this->enabled_ = true;
+      SREG = sreg;
       return;
    }
 
@@ -138,6 +136,9 @@ public:
    ********************************************************************************/
    void off(void)
    {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
       if (this->io_port_ == io_port::b)
       {
          PORTB &= ~(1 << this->pin_);
@@ -152,6 +153,7 @@ public:
       }
 
       this->enabled_ = false;
+      SREG = sreg;
       return;
    }
 
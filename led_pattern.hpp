@@ -0,0 +1,169 @@
+/********************************************************************************
+* led_pattern.hpp: Innehller funktionalitet fr uppspelning av mnster p
+*                  lysdioder lagrade i en vektor av typen led_vector via
+*                  klassen led_pattern. Varje mnster utgrs av en tabell
+*                  med bildrutor, dr varje bildruta innehller en bitmask
+*                  fr vilka lysdioder som ska vara tnda samt hur lnge
+*                  bildrutan ska visas. Tabellerna lagras i programminnet
+*                  (PROGMEM), s att ven stora animationer inte tar ngon
+*                  plats i RAM-minnet. Bildrutorna lses en i taget vid
+*                  uppspelning.
+*
+*                  Egna mnster deklareras enligt nedan:
+*
+*                  static const led_frame my_pattern[] PROGMEM =
+*                  {
+*                     { 0x01, 100 }, { 0x02, 100 }, { 0x04, 200 }
+*                  };
+*
+*                  led_pattern pattern(my_pattern);
+********************************************************************************/
+#ifndef LED_PATTERN_HPP_
+#define LED_PATTERN_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "led_vector.hpp"
+#include "delay.hpp"
+#include <avr/pgmspace.h>
+
+/********************************************************************************
+* led_frame: Strukt fr en bildruta i ett mnster.
+********************************************************************************/
+struct led_frame
+{
+   uint8_t mask;         /* Bitmask, dr bit 0 motsvarar frsta lysdioden. */
+   uint16_t duration_ms; /* Tid som bildrutan ska visas mtt i millisekunder. */
+};
+
+/********************************************************************************
+* led_pattern: Klass fr uppspelning av ett mnster lagrat i programminnet.
+*              Uppspelning kan ske blockerande via play eller bildruta fr
+*              bildruta via next, exempelvis frn en timers callbackrutin,
+*              dr returnerad tid anvnds som tid till nsta bildruta.
+********************************************************************************/
+class led_pattern
+{
+private:
+   const led_frame* frames_ = nullptr; /* Pekare till tabell i programminnet. */
+   uint8_t num_frames_ = 0;            /* Antal bildrutor i tabellen. */
+   uint8_t index_ = 0;                 /* Index fr nsta bildruta. */
+
+public:
+
+   /* Frdefinierade mnster fr upp till tta lysdioder: */
+   static inline const led_frame CHASE[] PROGMEM =
+   {
+      { 0x01, 100 }, { 0x02, 100 }, { 0x04, 100 }, { 0x08, 100 },
+      { 0x10, 100 }, { 0x20, 100 }, { 0x40, 100 }, { 0x80, 100 }
+   };
+
+   static inline const led_frame KNIGHT_RIDER[] PROGMEM =
+   {
+      { 0x01, 80 }, { 0x02, 80 }, { 0x04, 80 }, { 0x08, 80 },
+      { 0x10, 80 }, { 0x20, 80 }, { 0x40, 80 }, { 0x80, 80 },
+      { 0x40, 80 }, { 0x20, 80 }, { 0x10, 80 }, { 0x08, 80 },
+      { 0x04, 80 }, { 0x02, 80 }
+   };
+
+   static inline const led_frame ALTERNATE[] PROGMEM =
+   {
+      { 0x55, 250 }, { 0xAA, 250 }
+   };
+
+   static inline const led_frame BLINK[] PROGMEM =
+   {
+      { 0xFF, 500 }, { 0x00, 500 }
+   };
+
+   /********************************************************************************
+   * led_pattern: Initierar nytt mnster frn angiven tabell i programminnet.
+   *
+   *              - frames    : Pekare till tabellen i programminnet.
+   *              - num_frames: Antal bildrutor i tabellen.
+   ********************************************************************************/
+   led_pattern(const led_frame* frames,
+               const uint8_t num_frames)
+      : frames_(frames), num_frames_(num_frames) { }
+
+   /********************************************************************************
+   * led_pattern: Initierar nytt mnster frn angiven tabell i programminnet,
+   *              dr antalet bildrutor tas fram automatiskt.
+   *
+   *              - frames: Referens till tabellen i programminnet.
+   ********************************************************************************/
+   template<uint8_t N>
+   led_pattern(const led_frame (&frames)[N])
+      : frames_(frames), num_frames_(N) { }
+
+   /********************************************************************************
+   * size: Returnerar antalet bildrutor i mnstret.
+   ********************************************************************************/
+   uint8_t size(void) const
+   {
+      return this->num_frames_;
+   }
+
+   /********************************************************************************
+   * frame: Lser angiven bildruta frn programminnet.
+   *
+   *        - index: Bildrutans index (0 - size() - 1).
+   ********************************************************************************/
+   led_frame frame(const uint8_t index) const
+   {
+      led_frame frame = { 0, 0 };
+      if (index < this->num_frames_)
+      {
+         memcpy_P(&frame, &this->frames_[index], sizeof(frame));
+      }
+      return frame;
+   }
+
+   /********************************************************************************
+   * next: Visar nsta bildruta p angivna lysdioder och returnerar tiden
+   *       som bildrutan ska visas mtt i millisekunder. Efter sista
+   *       bildrutan brjar mnstret om.
+   *
+   *       - leds: Referens till lysdioderna som mnstret ska visas p.
+   ********************************************************************************/
+   uint16_t next(led_vector& leds)
+   {
+      if (!this->num_frames_) return 0;
+      const led_frame frame = this->frame(this->index_);
+      leds.write(frame.mask);
+      if (++this->index_ >= this->num_frames_) this->index_ = 0;
+      return frame.duration_ms;
+   }
+
+   /********************************************************************************
+   * restart: Startar om mnstret frn frsta bildrutan.
+   ********************************************************************************/
+   void restart(void)
+   {
+      this->index_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * play: Spelar upp mnstret en gng p angivna lysdioder, varefter
+   *       lysdioderna slcks. Uppspelningen r blockerande.
+   *
+   *       - leds: Referens till lysdioderna som mnstret ska visas p.
+   ********************************************************************************/
+   void play(led_vector& leds)
+   {
+      this->restart();
+
+      for (uint8_t i = 0; i < this->num_frames_; ++i)
+      {
+         const uint16_t duration_ms = this->next(leds);
+         delay::ms(duration_ms);
+      }
+
+      leds.off();
+      this->restart();
+      return;
+   }
+};
+
+#endif /* LED_PATTERN_HPP_ */
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "misc.hpp"
 #include "vector.hpp"
 #include "led.hpp"
+#include "delay.hpp"
 
 /********************************************************************************
 * led_vector: Dynamisk vektor fr lagring och styrning av led-objekt, vilket
@@ -80,6 +81,33 @@ public:
       return;
    }
 
+   /********************************************************************************
+   * write: Tnder respektive slcker lysdioderna lagrade i angiven vektor
+   *        enligt angiven bitmask, dr bit 0 motsvarar frsta lysdioden.
+   *        Lysdioder utver de tta frsta slcks.
+   *
+   *        - mask: Bitmask dr en etta innebr att motsvarande lysdiod tnds.
+   ********************************************************************************/
+   void write(const uint8_t mask)
+   {
+      uint8_t bit = 0;
+
+      for (auto& i : *this)
+      {
+         if (bit < 8 && (mask & (1 << bit)))
+         {
+            i.on();
+         }
+         else
+         {
+            i.off();
+         }
+
+         bit++;
+      }
+      return;
+   }
+
    /********************************************************************************
    * blink_collectively: Genomfr kollektiv (synkroniserad) blinkning av samtliga 
    *                     lysdioder lagrade i angiven vektor.
@@ -90,9 +118,9 @@ public:
    void blink_colletively(const uint16_t& blink_speed_ms)
    {
       this->on();
-      misc::delay_ms(blink_speed_ms);
+      delay::ms(blink_speed_ms);
       this->off();
-      misc::delay_ms(blink_speed_ms);
+      delay::ms(blink_speed_ms);
       return;
    }
 
@@ -111,7 +139,7 @@ public:
       for (auto& i : *this)
       {
          i.on();
-         misc::delay_ms(blink_speed_ms);
+         delay::ms(blink_speed_ms);
          i.off();
       }
 
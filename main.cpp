@@ -9,19 +9,22 @@
 *
 *           Fr att toggla aktivering av timergenererade avbrott p timer-
 *           kretsarna anvnds tv tryckknappar anslutna till pin 12 - 13 
-*           (PORTB4 - PORTB4), som PCI-avbrott har aktiverats p. 
-*           Vid nedtryckning av tryckknappen ansluten till pin 12 (PORTB4) 
-*           togglas timergenererat avbrott p timer1, medan nedtryckning av 
-*           tryckknappen ansluten till pin 13 (PORTB5) medfr toggling av 
-*           timergenererat avbrott p timer2.
+*           (PORTB4 - PORTB5). Vid nedtryckning av tryckknappen ansluten till
+*           pin 12 (PORTB4) togglas timergenererat avbrott p timer1, medan
+*           nedtryckning av tryckknappen ansluten till pin 13 (PORTB5) medfr
+*           toggling av timergenererat avbrott p timer2.
 *
-*           Fr att undvika multipla avbrott p grund av kontaktstudsar vid
-*           nedtryckning av tryckknapparna inaktiveras PCI-avbrott p 
-*           I/O-port B i 300 ms efter att avbrott sker. Rkningen genomfrs 
-*           av timerkrets timer 0, som timergenererat avbrott aktiveras d 
-*           aktiveras p. Efter 300 ms har passerat terstlls PCI-avbrott p 
-*           I/O-port B och timergenererat avbrott p timer 0 inaktiveras infr
-*           nsta nedtryckning av tryckknapparna.
+*           Tryckknapparna avlses av detektorer som uppdateras av den delade
+*           ticken, vilket filtrerar bort kontaktstudsar. Avstudsade event
+*           placeras i en k, som tms i huvudprogrammet.
+*
+*           Hndelser i avbrottsrutinerna spras via klassen trace. Nr
+*           tecknet 'd' tas emot via USART0 skickas sprningen till
+*           vrddatorn, dr den kan avkodas via tools/trace_decode.py.
+*           Nr tecknet 'm' tas emot skickas aktuell minnesstatus och nr
+*           tecknet 'l' tas emot skickas processorns belastning, som mts
+*           i tomgngsloopen. Nr tecknet 'i' tas emot skickas avbrotts-
+*           rutinernas exekveringstider samt verskridna tidsbudgetar.
 ********************************************************************************/
 #include "header.hpp"
 
@@ -35,7 +38,46 @@ int main(void)
 
    while (1)
    {
+      uint8_t c;
+      button_event event;
+      cpu_load::idle();
+
+      while (!button_events.pop(event))
+      {
+         if (event.event == button_event::type::press || event.event == button_event::type::release)
+         {
+            const bool pressed = event.event == button_event::type::press;
+
+            if (event.source == &b1)
+            {
+               b1_changed(pressed);
+            }
+            else if (event.source == &b2)
+            {
+               b2_changed(pressed);
+            }
+         }
+      }
 
+      if (!serial::read(c))
+      {
+         if (c == 'd')
+         {
+            trace::dump();
+         }
+         else if (c == 'm')
+         {
+            memory::report();
+         }
+         else if (c == 'l')
+         {
+            cpu_load::report();
+         }
+         else if (c == 'i')
+         {
+            isr_policy::report();
+         }
+      }
    }
 
    return 0;
@@ -0,0 +1,165 @@
+/********************************************************************************
+* memory.hpp: Innehller funktionalitet fr vervakning av RAM-minnet via den
+*             statiska klassen memory. Vid start fylls oanvnt RAM mellan
+*             heapen och stacken med ett knt mnster (stack painting). Ju
+*             djupare stacken ngon gng har ntt, desto mer av mnstret har
+*             skrivits ver, vilket gr att stackens hgvattenmrke kan tas
+*             fram i efterhand genom att rkna de bytes dr mnstret finns kvar.
+*
+*             ATmega328P har 2 kB RAM, dr globala variabler ligger frst
+*             fljt av heapen, som vxer uppt (exempelvis vid realloc i
+*             klassen vector), medan stacken vxer nedt frn slutet av
+*             RAM-minnet. Ifall heapen och stacken mts skrivs data ver
+*             utan frvarning. Via klassen memory kan avstndet mellan dem
+*             fljas, s att buffertar kan dimensioneras utan gissningar.
+*
+*             Minneslayout:
+*
+*             __data_start ... __heap_start ... __brkval ... SP ... RAMEND
+*             [globala]        [heap -->]       [fritt]     [<-- stack]
+********************************************************************************/
+#ifndef MEMORY_HPP_
+#define MEMORY_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "serial.hpp"
+
+/* Symboler definierade av lnkaren samt malloc i avr-libc: */
+extern "C"
+{
+   extern uint8_t __heap_start; /* Brjan av heapen. */
+   extern char* __brkval;       /* Aktuellt slut p heapen, 0 ifall heapen r tom. */
+}
+
+/********************************************************************************
+* memory: Statisk klass fr vervakning av heapen och stacken. Anrop av
+*         paint br ske frst i setup, innan stacken har hunnit vxa.
+********************************************************************************/
+class memory
+{
+private:
+   static constexpr uint8_t PAINT_ = 0xC5;       /* Mnster i oanvnt RAM. */
+   static constexpr uint8_t PAINT_MARGIN_ = 32;  /* Marginal under aktuell stackpekare. */
+   static inline uint16_t painted_ = 0;          /* Antal bytes som fylldes vid paint. */
+
+   /********************************************************************************
+   * heap_end: Returnerar adressen till frsta byte efter heapen.
+   ********************************************************************************/
+   static uint8_t* heap_end(void)
+   {
+      return __brkval ? reinterpret_cast<uint8_t*>(__brkval) : &__heap_start;
+   }
+
+public:
+
+   /********************************************************************************
+   * paint: Fyller oanvnt RAM mellan heapen och aktuell stackpekare med ett
+   *        knt mnster. En marginal lmnas under stackpekaren, s att
+   *        aktuell stackram inte pverkas.
+   ********************************************************************************/
+   static void paint(void)
+   {
+      uint8_t* const start = heap_end();
+      uint8_t* const end = reinterpret_cast<uint8_t*>(SP - PAINT_MARGIN_);
+      painted_ = 0;
+
+      for (uint8_t* i = start; i < end; ++i)
+      {
+         *i = PAINT_;
+         painted_++;
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * heap_break: Returnerar adressen till aktuellt slut p heapen.
+   ********************************************************************************/
+   static uint16_t heap_break(void)
+   {
+      return static_cast<uint16_t>(reinterpret_cast<uintptr_t>(heap_end()));
+   }
+
+   /********************************************************************************
+   * heap_size: Returnerar antalet bytes som heapen upptar.
+   ********************************************************************************/
+   static uint16_t heap_size(void)
+   {
+      return heap_break() - static_cast<uint16_t>(reinterpret_cast<uintptr_t>(&__heap_start));
+   }
+
+   /********************************************************************************
+   * stack_size: Returnerar antalet bytes som stacken upptar just nu.
+   ********************************************************************************/
+   static uint16_t stack_size(void)
+   {
+      return RAMEND - SP;
+   }
+
+   /********************************************************************************
+   * free_gap: Returnerar antalet lediga bytes mellan heapen och stacken just
+   *           nu, alternativt 0 ifall de har kolliderat.
+   ********************************************************************************/
+   static uint16_t free_gap(void)
+   {
+      const uint16_t sp = SP;
+      const uint16_t brk = heap_break();
+      return sp > brk ? sp - brk : 0;
+   }
+
+   /********************************************************************************
+   * stack_high_water: Returnerar det strsta antal bytes som stacken har
+   *                   upptagit sedan paint anropades, inklusive avbrotts-
+   *                   rutiner. Mnstret sks frn heapens slut och uppt,
+   *                   dr frsta verskrivna byte markerar stackens
+   *                   djupaste punkt.
+   ********************************************************************************/
+   static uint16_t stack_high_water(void)
+   {
+      const uint8_t* i = heap_end();
+      const uint8_t* const end = reinterpret_cast<const uint8_t*>(SP);
+      while (i < end && *i == PAINT_) ++i;
+      return RAMEND - static_cast<uint16_t>(reinterpret_cast<uintptr_t>(i)) + 1;
+   }
+
+   /********************************************************************************
+   * unused: Returnerar antalet bytes mellan heapen och stacken som aldrig
+   *         har anvnts sedan paint anropades, dvs. minsta marginal hittills.
+   ********************************************************************************/
+   static uint16_t unused(void)
+   {
+      const uint8_t* i = heap_end();
+      const uint8_t* const end = reinterpret_cast<const uint8_t*>(SP);
+      uint16_t count = 0;
+      while (i < end && *i++ == PAINT_) count++;
+      return count;
+   }
+
+   /********************************************************************************
+   * painted: Returnerar antalet bytes som fylldes med mnstret vid paint.
+   ********************************************************************************/
+   static uint16_t painted(void)
+   {
+      return painted_;
+   }
+
+   /********************************************************************************
+   * report: Skickar aktuell minnesstatus via USART0 som rader p formen
+   *         "namn=vrde", dr samtliga vrden anges i bytes. USART0 mste
+   *         vara initierad via serial::init. Vid lyckad verfring
+   *         returneras 0, annars felkod 1.
+   ********************************************************************************/
+   static int report(void)
+   {
+      int result = 0;
+      result |= serial::print_value("heap", heap_size());
+      result |= serial::print_value("stack", stack_size());
+      result |= serial::print_value("stack_max", stack_high_water());
+      result |= serial::print_value("free", free_gap());
+      result |= serial::print_value("unused", unused());
+      return result;
+   }
+};
+
+#endif /* MEMORY_HPP_ */
\ No newline at end of file
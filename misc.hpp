@@ -63,7 +63,8 @@ enum class io_port
 namespace misc 
 {
    /********************************************************************************
-   * delay_ms: Genererar frdrjning mtt i millisekunder.
+   * delay_ms: Genererar frdrjning mtt i millisekunder via busy wait.
+   *           Se klassen delay fr frdrjning i vilolge.
    *
    *           - delay_time_ms: Referens till angiven frdrjningstid.
    ********************************************************************************/
@@ -76,7 +77,9 @@ namespace misc
    };
 
    /********************************************************************************
-   * delay_us: Genererar frdrjning mtt i mikrosekunder.
+   * delay_us: Genererar frdrjning mtt i mikrosekunder via busy wait.
+   *           Varje varv tar mer n 1 s p grund av loopens overhead,
+   *           anvnd delay::us fr kalibrerade frdrjningar.
    *
    *           - delay_time_us: Referens till angiven frdrjningstid.
    ********************************************************************************/
@@ -0,0 +1,250 @@
+/********************************************************************************
+* parallel_bus.hpp: Innehller funktionalitet fr parallell skrivning och
+*                   lsning av upp till tta bitar p godtyckliga pinnar via
+*                   klassen parallel_bus, exempelvis fr att driva parallella
+*                   displayer eller latchar.
+*
+*                   Vid initiering tas en mask fram fr varje anvnd I/O-port,
+*                   tillsammans med tv uppslagstabeller per I/O-port, som
+*                   omvandlar databytens lgre respektive vre nibble till
+*                   motsvarande bitar p I/O-porten. En skrivning utgrs
+*                   drmed av tv tabelluppslagningar samt en skrivning per
+*                   anvnd I/O-port (hgst tre), oavsett hur pinnarna r
+*                   utspridda. En lsning utgrs p motsvarande stt av en
+*                   lsning per anvnd I/O-port.
+*
+*                   Tabellerna upptar 32 byte RAM per anvnd I/O-port, varfr
+*                   bussar br deklareras globalt snarare n p stacken.
+********************************************************************************/
+#ifndef PARALLEL_BUS_HPP_
+#define PARALLEL_BUS_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "pin_map.hpp"
+
+/********************************************************************************
+* parallel_bus: Klass fr parallell skrivning samt lsning p upp till tta
+*               pinnar, dr bit 0 i databyten motsvarar frsta pinnen.
+********************************************************************************/
+class parallel_bus
+{
+public:
+   static constexpr uint8_t MAX_WIDTH = 8; /* Maximalt antal pinnar. */
+
+private:
+   /********************************************************************************
+   * port_t: Strukt fr frberknade data fr en anvnd I/O-port.
+   ********************************************************************************/
+   struct port_t
+   {
+      volatile uint8_t* port; /* Pekare till PORTx. */
+      volatile uint8_t* pin;  /* Pekare till PINx. */
+      volatile uint8_t* ddr;  /* Pekare till DDRx. */
+      uint8_t mask;           /* Bussens bitar p I/O-porten. */
+      uint8_t low[16];        /* Portbitar fr databytens lgre nibble. */
+      uint8_t high[16];       /* Portbitar fr databytens vre nibble. */
+   };
+
+   port_t ports_[3];             /* Frberknade data per anvnd I/O-port. */
+   uint8_t num_ports_ = 0;       /* Antal anvnda I/O-portar. */
+   uint8_t width_ = 0;           /* Antal pinnar i bussen. */
+   uint8_t bits_[MAX_WIDTH] = { }; /* Index fr I/O-port (bit 4 - 7) samt pin (bit 0 - 3) per databit. */
+
+   /********************************************************************************
+   * add_port: Returnerar index fr angiven I/O-port bland anvnda I/O-portar,
+   *           varefter I/O-porten lggs till ifall den inte redan anvnds.
+   *
+   *           - io_port: I/O-porten som ska lggas till.
+   ********************************************************************************/
+   uint8_t add_port(const io_port io_port)
+   {
+      volatile uint8_t* port = io_port == io_port::b ? &PORTB : (io_port == io_port::c ? &PORTC : &PORTD);
+
+      for (uint8_t i = 0; i < this->num_ports_; ++i)
+      {
+         if (this->ports_[i].port == port) return i;
+      }
+
+      port_t& entry = this->ports_[this->num_ports_];
+      entry.port = port;
+      entry.pin = io_port == io_port::b ? &PINB : (io_port == io_port::c ? &PINC : &PIND);
+      entry.ddr = io_port == io_port::b ? &DDRB : (io_port == io_port::c ? &DDRC : &DDRD);
+      entry.mask = 0;
+
+      for (uint8_t i = 0; i < 16; ++i)
+      {
+         entry.low[i] = 0;
+         entry.high[i] = 0;
+      }
+
+      return this->num_ports_++;
+   }
+
+public:
+
+   /********************************************************************************
+   * parallel_bus: Initierar ny buss p angivna pinnar, som stts till
+   *               utportar. Ifall ngon pin r ogiltig eller frekommer
+   *               flera gnger blir bussen tom, vilket kan kontrolleras via
+   *               valid.
+   *
+   *               - pins : Pekare till flt med pinnarnas nummer p Arduino
+   *                        Uno, dr frsta pinnen motsvarar bit 0.
+   *               - width: Antal pinnar i fltet (1 - 8).
+   ********************************************************************************/
+   parallel_bus(const uint8_t* pins,
+                const uint8_t width)
+   {
+      if (!pins || width == 0 || width > MAX_WIDTH) return;
+
+      for (uint8_t i = 0; i < width; ++i)
+      {
+         io_port io_port;
+         uint8_t bit;
+
+         if (pin_map::resolve(pins[i], io_port, bit))
+         {
+            this->num_ports_ = 0;
+            return;
+         }
+
+         const uint8_t index = this->add_port(io_port);
+         port_t& entry = this->ports_[index];
+
+         if (entry.mask & (1 << bit))
+         {
+            this->num_ports_ = 0;
+            return;
+         }
+
+         entry.mask |= (1 << bit);
+         this->bits_[i] = (index << 4) | bit;
+
+         for (uint8_t j = 0; j < 16; ++j)
+         {
+            if (i < 4 && (j & (1 << i))) entry.low[j] |= (1 << bit);
+            if (i >= 4 && (j & (1 << (i - 4)))) entry.high[j] |= (1 << bit);
+         }
+      }
+
+      this->width_ = width;
+      this->output();
+      return;
+   }
+
+   /********************************************************************************
+   * valid: Indikerar ifall bussen initierades korrekt.
+   ********************************************************************************/
+   bool valid(void) const
+   {
+      return this->width_ != 0;
+   }
+
+   /********************************************************************************
+   * width: Returnerar antalet pinnar i bussen.
+   ********************************************************************************/
+   uint8_t width(void) const
+   {
+      return this->width_;
+   }
+
+   /********************************************************************************
+   * output: Stter bussens pinnar till utportar.
+   ********************************************************************************/
+   void output(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      for (uint8_t i = 0; i < this->num_ports_; ++i)
+      {
+         *this->ports_[i].ddr |= this->ports_[i].mask;
+      }
+
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * input: Stter bussens pinnar till inportar.
+   *
+   *        - pullup: Indikerar ifall interna pullup-resistorer ska aktiveras
+   *                  (default = false).
+   ********************************************************************************/
+   void input(const bool pullup = false)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      for (uint8_t i = 0; i < this->num_ports_; ++i)
+      {
+         port_t& entry = this->ports_[i];
+         *entry.ddr &= ~entry.mask;
+
+         if (pullup)
+         {
+            *entry.port |= entry.mask;
+         }
+         else
+         {
+            *entry.port &= ~entry.mask;
+         }
+      }
+
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * write: Skriver angiven byte till bussen, dr bit 0 hamnar p frsta
+   *        pinnen. vriga pinnar p I/O-portarna pverkas inte. Samtliga
+   *        I/O-portar uppdateras med avbrott inaktiverade, s att avbrotts-
+   *        rutiner som skriver till samma I/O-port inte strs.
+   *
+   *        - data: Byten som ska skrivas.
+   ********************************************************************************/
+   void write(const uint8_t data)
+   {
+      const uint8_t low = data & 0x0F;
+      const uint8_t high = data >> 4;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      for (uint8_t i = 0; i < this->num_ports_; ++i)
+      {
+         const port_t& entry = this->ports_[i];
+         *entry.port = (*entry.port & ~entry.mask) | entry.low[low] | entry.high[high];
+      }
+
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * read: Lser bussens pinnar och returnerar dessa som en byte, dr bit 0
+   *       motsvarar frsta pinnen.
+   ********************************************************************************/
+   uint8_t read(void) const
+   {
+      uint8_t values[3] = { };
+      uint8_t data = 0;
+
+      for (uint8_t i = 0; i < this->num_ports_; ++i)
+      {
+         values[i] = *this->ports_[i].pin;
+      }
+
+      for (uint8_t i = 0; i < this->width_; ++i)
+      {
+         if (values[this->bits_[i] >> 4] & (1 << (this->bits_[i] & 0x0F)))
+         {
+            data |= (1 << i);
+         }
+      }
+
+      return data;
+   }
+};
+
+#endif /* PARALLEL_BUS_HPP_ */
\ No newline at end of file
@@ -0,0 +1,172 @@
+/********************************************************************************
+* pcint.hpp: Innehller funktionalitet fr generell hantering av PCI-avbrott
+*            p samtliga I/O-portar via klassen pcint. Vid PCI-avbrott jmfrs
+*            aktuell niv p I/O-porten med fregende niv via XOR, varefter
+*            endast de pinnar som faktiskt har ndrats samt har PCI-avbrott
+*            aktiverat behandlas. Fr varje sdan pin anropas den hanterare
+*            som har registrerats fr pinnen. Drmed beror tiden i
+*            avbrottsrutinen p antalet ndrade pinnar snarare n antalet
+*            registrerade tryckknappar, samtidigt som samtliga 20 pinnar p
+*            Arduino Uno kan anvndas.
+*
+*            Avbrottsrutinerna ska endast anropa dispatch med aktuell I/O-port:
+*
+*            I/O-port     pin (Arduino Uno)     Avbrottsvektor
+*               B              8 - 13             PCINT0_vect
+*               C             A0 - A5             PCINT1_vect
+*               D              0 - 7              PCINT2_vect
+********************************************************************************/
+#ifndef PCINT_HPP_
+#define PCINT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "button.hpp"
+#include "pin_map.hpp"
+
+/********************************************************************************
+* pcint: Statisk klass fr registrering av hanterare per pin samt utdelning
+*        av PCI-avbrott till dessa. Hanterarna anropas frn avbrottsrutinen
+*        och ska drmed vara korta.
+********************************************************************************/
+class pcint
+{
+public:
+   typedef void (*handler)(const bool state); /* Hanterare, anropas med pinnens nya niv. */
+
+private:
+   static inline handler handlers_[3][8] = { };  /* Registrerade hanterare per I/O-port och pin. */
+   static inline uint8_t previous_[3] = { };     /* Fregende niv p respektive I/O-port. */
+
+   /********************************************************************************
+   * read_port: Returnerar aktuell insignal frn angiven I/O-port.
+   *
+   *            - io_port: I/O-porten som ska lsas av.
+   ********************************************************************************/
+   static inline uint8_t read_port(const enum io_port io_port)
+   {
+      if (io_port == io_port::b) return PINB;
+      else if (io_port == io_port::c) return PINC;
+      else return PIND;
+   }
+
+   /********************************************************************************
+   * mask: Returnerar PCI-maskregistret fr angiven I/O-port.
+   *
+   *       - io_port: Aktuell I/O-port.
+   ********************************************************************************/
+   static inline volatile uint8_t& mask(const enum io_port io_port)
+   {
+      if (io_port == io_port::b) return PCMSK0;
+      else if (io_port == io_port::c) return PCMSK1;
+      else return PCMSK2;
+   }
+
+   /********************************************************************************
+   * install: Registrerar hanterare fr angiven pin och sparar aktuell niv p
+   *          I/O-porten, s att redan rdande niver inte tolkas som ndringar.
+   *
+   *          - port       : I/O-porten som pinnen tillhr.
+   *          - bit        : Pin-nummer p aktuell I/O-port.
+   *          - new_handler: Hanteraren som ska anropas vid ndring.
+   ********************************************************************************/
+   static void install(const io_port port,
+                       const uint8_t bit,
+                       const handler new_handler)
+   {
+      const auto index = static_cast<uint8_t>(port);
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      handlers_[index][bit] = new_handler;
+      previous_[index] = read_port(port);
+      SREG = sreg;
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * attach: Registrerar hanterare fr angiven pin och aktiverar PCI-avbrott
+   *         p pinnen. Returnerar 0 vid lyckad registrering, annars felkod 1.
+   *
+   *         - pin        : Pin-nummer p Arduino Uno (0 - 19), exempelvis 12
+   *                        eller motsvarande port-nummer, exempelvis B4.
+   *         - new_handler: Hanteraren som ska anropas vid ndring p pinnen.
+   ********************************************************************************/
+   static int attach(const uint8_t pin,
+                     const handler new_handler)
+   {
+      io_port port;
+      uint8_t bit;
+      if (pin_map::resolve(pin, port, bit)) return 1;
+
+      install(port, bit, new_handler);
+      mask(port) |= (1 << bit);
+      misc::enable_pin_change_interrupt(port);
+      asm("SEI");
+      return 0;
+   }
+
+   /********************************************************************************
+   * attach: Registrerar hanterare fr angiven tryckknapp och aktiverar
+   *         PCI-avbrott p tryckknappens pin. Returnerar 0 vid lyckad
+   *         registrering, annars felkod 1.
+   *
+   *         - button     : Referens till tryckknappen.
+   *         - new_handler: Hanteraren som ska anropas vid ndring p pinnen.
+   ********************************************************************************/
+   static int attach(button& button,
+                     const handler new_handler)
+   {
+      if (button.get_port() == io_port::none) return 1;
+      install(button.get_port(), button.pin(), new_handler);
+      button.enable_interrupt();
+      return 0;
+   }
+
+   /********************************************************************************
+   * detach: Inaktiverar PCI-avbrott samt tar bort registrerad hanterare fr
+   *         angiven pin.
+   *
+   *         - pin: Pin-nummer p Arduino Uno (0 - 19).
+   ********************************************************************************/
+   static void detach(const uint8_t pin)
+   {
+      io_port port;
+      uint8_t bit;
+      if (pin_map::resolve(pin, port, bit)) return;
+
+      mask(port) &= ~(1 << bit);
+      install(port, bit, nullptr);
+      return;
+   }
+
+   /********************************************************************************
+   * dispatch: Behandlar PCI-avbrott p angiven I/O-port. ndrade pinnar tas
+   *           fram via XOR mellan aktuell och fregende niv, maskat med
+   *           aktiverade PCI-avbrott. Drefter anropas registrerad hanterare
+   *           fr varje ndrad pin med pinnens nya niv. Ska anropas frn
+   *           motsvarande avbrottsrutin.
+   *
+   *           - io_port: I/O-porten som avbrottet gde rum p.
+   ********************************************************************************/
+   static void dispatch(const enum io_port io_port)
+   {
+      const auto index = static_cast<uint8_t>(io_port);
+      const uint8_t current = read_port(io_port);
+      uint8_t changed = (current ^ previous_[index]) & mask(io_port);
+      previous_[index] = current;
+
+      for (uint8_t bit = 0; changed; ++bit, changed >>= 1)
+      {
+         if ((changed & 0x01) && handlers_[index][bit])
+         {
+            handlers_[index][bit](current & (1 << bit));
+         }
+      }
+
+      return;
+   }
+};
+
+#endif /* PCINT_HPP_ */
\ No newline at end of file
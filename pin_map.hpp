@@ -0,0 +1,113 @@
+/********************************************************************************
+* pin_map.hpp: Innehller funktionalitet fr avkodning av pin-nummer p
+*              Arduino Uno till I/O-port samt pin-nummer p aktuell I/O-port
+*              via den statiska klassen pin_map. Avkodningen sker via en
+*              tabell som lagras i programminnet (PROGMEM), s att varje
+*              avkodning utgrs av en enda tabelluppslagning utan att ngon
+*              plats i RAM-minnet anvnds.
+*
+*              Varje post i tabellen utgrs av en byte, dr de fyra mest
+*              signifikanta bitarna utgr I/O-porten (enumerationsklassen
+*              io_port) och de fyra minst signifikanta bitarna utgr
+*              pin-numret p I/O-porten:
+*
+*              pin (Arduino Uno)     I/O-port     pin p I/O-port
+*                   0 - 7               D              0 - 7
+*                   8 - 13              B              0 - 5
+*                  14 - 19 (A0 - A5)    C              0 - 5
+********************************************************************************/
+#ifndef PIN_MAP_HPP_
+#define PIN_MAP_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include <avr/pgmspace.h>
+
+/********************************************************************************
+* pin_map: Statisk klass fr avkodning av pin-nummer via tabell i
+*          programminnet.
+********************************************************************************/
+class pin_map
+{
+public:
+   static constexpr uint8_t NUM_PINS = 20; /* Antal pinnar p Arduino Uno. */
+
+private:
+   /********************************************************************************
+   * entry: Returnerar en post i tabellen fr angiven I/O-port samt pin.
+   *
+   *        - io_port: I/O-porten som pinnen tillhr.
+   *        - bit    : Pin-nummer p aktuell I/O-port.
+   ********************************************************************************/
+   static constexpr uint8_t entry(const io_port io_port,
+                                  const uint8_t bit)
+   {
+      return (static_cast<uint8_t>(io_port) << 4) | bit;
+   }
+
+   /* Tabell med I/O-port samt pin-nummer fr respektive pin, lagrad i programminnet: */
+   static inline const uint8_t table_[NUM_PINS] PROGMEM =
+   {
+      entry(io_port::d, 0), entry(io_port::d, 1), entry(io_port::d, 2), entry(io_port::d, 3),
+      entry(io_port::d, 4), entry(io_port::d, 5), entry(io_port::d, 6), entry(io_port::d, 7),
+      entry(io_port::b, 0), entry(io_port::b, 1), entry(io_port::b, 2), entry(io_port::b, 3),
+      entry(io_port::b, 4), entry(io_port::b, 5), entry(io_port::c, 0), entry(io_port::c, 1),
+      entry(io_port::c, 2), entry(io_port::c, 3), entry(io_port::c, 4), entry(io_port::c, 5)
+   };
+
+   /********************************************************************************
+   * read: Returnerar posten fr angiven pin, alternativt en post med
+   *       io_port::none ifall pinnen inte finns.
+   *
+   *       - pin: Pin-nummer p Arduino Uno (0 - 19).
+   ********************************************************************************/
+   static uint8_t read(const uint8_t pin)
+   {
+      if (pin >= NUM_PINS) return entry(io_port::none, 0);
+      return pgm_read_byte(&table_[pin]);
+   }
+
+public:
+
+   /********************************************************************************
+   * resolve: Avkodar angiven pin till I/O-port samt pin-nummer p I/O-porten.
+   *          Vid lyckad avkodning returneras 0. Ifall pinnen inte finns stts
+   *          I/O-porten till io_port::none och felkod 1 returneras.
+   *
+   *          - pin    : Pin-nummer p Arduino Uno (0 - 19), exempelvis 12
+   *                     eller motsvarande port-nummer, exempelvis B4.
+   *          - io_port: Referens till variabel dr I/O-porten lagras.
+   *          - bit    : Referens till variabel dr pin-numret p porten lagras.
+   ********************************************************************************/
+   static int resolve(const uint8_t pin,
+                      io_port& io_port,
+                      uint8_t& bit)
+   {
+      const uint8_t value = read(pin);
+      io_port = static_cast<enum io_port>(value >> 4);
+      bit = value & 0x0F;
+      return io_port == io_port::none ? 1 : 0;
+   }
+
+   /********************************************************************************
+   * port: Returnerar I/O-porten som angiven pin tillhr.
+   *
+   *       - pin: Pin-nummer p Arduino Uno (0 - 19).
+   ********************************************************************************/
+   static io_port port(const uint8_t pin)
+   {
+      return static_cast<io_port>(read(pin) >> 4);
+   }
+
+   /********************************************************************************
+   * bit: Returnerar angiven pins pin-nummer p aktuell I/O-port.
+   *
+   *      - pin: Pin-nummer p Arduino Uno (0 - 19).
+   ********************************************************************************/
+   static uint8_t bit(const uint8_t pin)
+   {
+      return read(pin) & 0x0F;
+   }
+};
+
+#endif /* PIN_MAP_HPP_ */
\ No newline at end of file
@@ -0,0 +1,321 @@
+/********************************************************************************
+* profiler.hpp: Innehller funktionalitet fr tidmtning av godtyckliga
+*               kodavsnitt direkt p mikrodatorn via klasserna profile_site
+*               samt profiler. Ett profile_site-objekt samlar statistik fr
+*               ett givet kodavsnitt (antal mtningar, minsta, strsta samt
+*               total tid och ett histogram med logaritmisk skala), medan ett
+*               profiler-objekt mter tiden frn att det skapas till att det
+*               raderas (RAII), exempelvis enligt nedan:
+*
+*               static profile_site read_site("adc::read");
+*
+*               {
+*                  profiler p(read_site);
+*                  result = a0.read();
+*               }
+*
+*               Tiden mts via timer::timestamp med upplsningen 0.5 s
+*               (8 klockcykler), vilket krver att den delade ticken r
+*               startad, exempelvis via profiler::init. Varje mtning tar
+*               ngra f mikrosekunder, vilket ingr i uppmtt tid.
+*
+*               Vid release-bygge (NDEBUG definierat) kompileras samtliga
+*               mtningar bort, s att profiler-objekt kan lmnas kvar i
+*               koden utan att pverka programmets storlek eller hastighet.
+********************************************************************************/
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "timer.hpp"
+#include "serial.hpp"
+
+/********************************************************************************
+* profile_site: Klass fr lagring av statistik fr ett kodavsnitt. Samtliga
+*               tider anges i enheten 0.5 s. Histogrammet har tta fack,
+*               dr fack i innehller mtningar mellan 4^i - 4^(i + 1) enheter
+*               (fack 0 frn 0 och fack 7 uppt obegrnsat).
+********************************************************************************/
+class profile_site
+{
+public:
+   static constexpr uint8_t BUCKETS = 8; /* Antal fack i histogrammet. */
+
+private:
+   const char* name_ = nullptr;             /* Kodavsnittets namn. */
+#ifndef NDEBUG
+   uint32_t count_ = 0;                     /* Antal mtningar. */
+   uint32_t min_ = UINT32_MAX;              /* Kortaste uppmtta tid. */
+   uint32_t max_ = 0;                       /* Lngsta uppmtta tid. */
+   uint32_t total_ = 0;                     /* Summan av uppmtta tider. */
+   uint16_t histogram_[BUCKETS] = { };      /* Antal mtningar per fack. */
+
+   /********************************************************************************
+   * send: Placerar angiven text i sndningsbufferten fr USART0. Ifall
+   *       bufferten inte rymmer hela texten vntas tills plats finns.
+   *       Texter lngre n bufferten kastas av serial::print och rknas
+   *       d via serial::tx_dropped.
+   *
+   *       - s: Pekare till nollterminerad text.
+   ********************************************************************************/
+   static void send(const char* s)
+   {
+      const uint8_t capacity = serial::capacity();
+      uint8_t length = 0;
+      while (s[length] && length < capacity) length++;
+      while (serial::free_space() < length);
+      static_cast<void>(serial::print(s));
+      return;
+   }
+
+   /********************************************************************************
+   * send: Placerar angivet tal i decimal form i sndningsbufferten fr
+   *       USART0. Ifall bufferten r full vntas tills plats finns.
+   *
+   *       - value: Talet som ska skickas.
+   ********************************************************************************/
+   static void send(const uint32_t value)
+   {
+      while (serial::free_space() < 16);
+      static_cast<void>(serial::print(value));
+      return;
+   }
+#endif /* NDEBUG */
+
+public:
+
+   /********************************************************************************
+   * profile_site: Initierar nytt kodavsnitt med angivet namn.
+   *
+   *               - name: Pekare till nollterminerat namn p kodavsnittet.
+   ********************************************************************************/
+   profile_site(const char* name)
+      : name_(name) { }
+
+   /********************************************************************************
+   * name: Returnerar kodavsnittets namn.
+   ********************************************************************************/
+   const char* name(void) const
+   {
+      return this->name_;
+   }
+
+   /********************************************************************************
+   * add: Lgger till en mtning.
+   *
+   *      - elapsed: Uppmtt tid i enheten 0.5 s.
+   ********************************************************************************/
+   void add(const uint32_t elapsed)
+   {
+#ifndef NDEBUG
+      uint8_t bucket = 0;
+      for (uint32_t i = elapsed >> 2; i && bucket < BUCKETS - 1; i >>= 2) bucket++;
+
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->count_++;
+      this->total_ += elapsed;
+      if (elapsed < this->min_) this->min_ = elapsed;
+      if (elapsed > this->max_) this->max_ = elapsed;
+      if (this->histogram_[bucket] < UINT16_MAX) this->histogram_[bucket]++;
+      SREG = sreg;
+#else
+      static_cast<void>(elapsed);
+#endif /* NDEBUG */
+      return;
+   }
+
+   /********************************************************************************
+   * count: Returnerar antalet mtningar.
+   ********************************************************************************/
+   uint32_t count(void) const
+   {
+#ifndef NDEBUG
+      return this->count_;
+#else
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * min: Returnerar kortaste uppmtta tid i enheten 0.5 s.
+   ********************************************************************************/
+   uint32_t min(void) const
+   {
+#ifndef NDEBUG
+      return this->count_ ? this->min_ : 0;
+#else
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * max: Returnerar lngsta uppmtta tid i enheten 0.5 s.
+   ********************************************************************************/
+   uint32_t max(void) const
+   {
+#ifndef NDEBUG
+      return this->max_;
+#else
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * total: Returnerar summan av uppmtta tider i enheten 0.5 s.
+   ********************************************************************************/
+   uint32_t total(void) const
+   {
+#ifndef NDEBUG
+      return this->total_;
+#else
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * average: Returnerar genomsnittlig uppmtt tid i enheten 0.5 s.
+   ********************************************************************************/
+   uint32_t average(void) const
+   {
+#ifndef NDEBUG
+      return this->count_ ? this->total_ / this->count_ : 0;
+#else
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * histogram: Returnerar antalet mtningar i angivet fack.
+   *
+   *            - bucket: Fackets index (0 - 7).
+   ********************************************************************************/
+   uint16_t histogram(const uint8_t bucket) const
+   {
+#ifndef NDEBUG
+      return bucket < BUCKETS ? this->histogram_[bucket] : 0;
+#else
+      static_cast<void>(bucket);
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * clear: Nollstller samtliga mtningar.
+   ********************************************************************************/
+   void clear(void)
+   {
+#ifndef NDEBUG
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->count_ = 0;
+      this->min_ = UINT32_MAX;
+      this->max_ = 0;
+      this->total_ = 0;
+
+      for (auto& i : this->histogram_)
+      {
+         i = 0;
+      }
+
+      SREG = sreg;
+#endif /* NDEBUG */
+      return;
+   }
+
+   /********************************************************************************
+   * report: Skickar statistiken som en textrad via USART0 enligt nedan, dr
+   *         samtliga tider anges i enheten 0.5 s:
+   *
+   *         name n=<antal> min=<min> avg=<medel> max=<max> h=<fack 0>,...,<fack 7>
+   *
+   *         Ska anropas frn huvudprogrammet med avbrott aktiverade, d
+   *         funktionen vntar p plats i sndningsbufferten. USART0 mste
+   *         vara initierad via serial::init. Vid release-bygge skickas
+   *         ingenting.
+   ********************************************************************************/
+   void report(void) const
+   {
+#ifndef NDEBUG
+      send(this->name_);
+      send(" n=");
+      send(this->count());
+      send(" min=");
+      send(this->min());
+      send(" avg=");
+      send(this->average());
+      send(" max=");
+      send(this->max());
+      send(" h=");
+
+      for (uint8_t i = 0; i < BUCKETS; ++i)
+      {
+         if (i) send(",");
+         send(this->histogram(i));
+      }
+
+      send("\r\n");
+#endif /* NDEBUG */
+      return;
+   }
+};
+
+/********************************************************************************
+* profiler: Klass fr tidmtning av ett kodavsnitt. Tidsstmpel lses av nr
+*           objektet skapas och nr det raderas, varefter differensen lggs
+*           till i angivet profile_site-objekt.
+********************************************************************************/
+class profiler
+{
+private:
+#ifndef NDEBUG
+   profile_site& site_; /* Kodavsnittet som mtningen tillhr. */
+   uint32_t start_;     /* Tidsstmpel nr mtningen startade. */
+#endif /* NDEBUG */
+
+public:
+
+   /********************************************************************************
+   * init: Startar den delade ticken, som krvs fr tidmtningen. Vid lyckad
+   *       start returneras 0. Ifall den delade ticken inte kan startas,
+   *       eftersom Timer 2 r reserverad, returneras felkod 1.
+   ********************************************************************************/
+   static int init(void)
+   {
+#ifndef NDEBUG
+      return timer::start_shared_tick();
+#else
+      return 0;
+#endif /* NDEBUG */
+   }
+
+   /********************************************************************************
+   * profiler: Startar ny mtning fr angivet kodavsnitt.
+   *
+   *           - site: Referens till kodavsnittet som mtningen tillhr.
+   ********************************************************************************/
+#ifndef NDEBUG
+   profiler(profile_site& site)
+      : site_(site), start_(timer::timestamp()) { }
+#else
+   profiler(profile_site&) { }
+#endif /* NDEBUG */
+
+   /********************************************************************************
+   * ~profiler: Avslutar mtningen och lgger till uppmtt tid.
+   ********************************************************************************/
+   ~profiler(void)
+   {
+#ifndef NDEBUG
+      this->site_.add(timer::timestamp() - this->start_);
+#endif /* NDEBUG */
+      return;
+   }
+
+   /* Mtningen r knuten till ett kodblock och kan drmed inte kopieras: */
+   profiler(const profiler&) = delete;
+   profiler& operator=(const profiler&) = delete;
+};
+
+#endif /* PROFILER_HPP_ */
\ No newline at end of file
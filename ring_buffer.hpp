@@ -0,0 +1,129 @@
+/********************************************************************************
+* ring_buffer.hpp: Implementering av ringbuffertar (cirkulra ker) med fast
+*                  storlek via klassen ring_buffer. Ringbuffertarna allokerar
+*                  inget dynamiskt minne och kan anvndas fr att skicka data
+*                  mellan en avbrottsrutin och huvudprogrammet, frutsatt att
+*                  endast en part skriver och endast en part lser.
+********************************************************************************/
+#ifndef RING_BUFFER_HPP_
+#define RING_BUFFER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* ring_buffer: Generisk klass fr ringbuffertar av valfri datatyp med fast
+*              kapacitet. Kapaciteten mste utgras av en tvpotens mellan
+*              2 - 128, vilket gr att index kan rknas om via bitmaskning
+*              i stllet fr division. Index lagras som volatila 8-bitars
+*              variabler, s att lsning samt skrivning av dessa r atomra.
+********************************************************************************/
+template<class T, uint8_t N>
+class ring_buffer
+{
+   static_assert(N >= 2 && N <= 128 && (N & (N - 1)) == 0,
+                 "Ringbuffertens kapacitet mste vara en tvpotens mellan 2 - 128!");
+protected:
+   T data_[N];                 /* Flt innehllande lagrad data. */
+   volatile uint8_t head_ = 0; /* Index dr nsta element ska skrivas. */
+   volatile uint8_t tail_ = 0; /* Index dr nsta element ska lsas. */
+   static constexpr uint8_t MASK_ = N - 1; /* Bitmask fr omrkning av index. */
+
+public:
+
+   /********************************************************************************
+   * ring_buffer: Konstruktor, initierar ny tom ringbuffert.
+   ********************************************************************************/
+   ring_buffer(void) { }
+
+   /********************************************************************************
+   * capacity: Returnerar det maximala antalet element som kan lagras.
+   ********************************************************************************/
+   static constexpr uint8_t capacity(void)
+   {
+      return N;
+   }
+
+   /********************************************************************************
+   * size: Returnerar antalet element som fr nrvarande r lagrade.
+   ********************************************************************************/
+   uint8_t size(void) const
+   {
+      return static_cast<uint8_t>(this->head_ - this->tail_);
+   }
+
+   /********************************************************************************
+   * empty: Indikerar ifall ringbufferten r tom.
+   ********************************************************************************/
+   bool empty(void) const
+   {
+      return this->head_ == this->tail_;
+   }
+
+   /********************************************************************************
+   * full: Indikerar ifall ringbufferten r full.
+   ********************************************************************************/
+   bool full(void) const
+   {
+      return this->size() == N;
+   }
+
+   /********************************************************************************
+   * clear: Tmmer ringbufferten. Fr endast anropas nr ingen annan part
+   *        skriver till eller lser frn bufferten.
+   ********************************************************************************/
+   void clear(void)
+   {
+      this->head_ = 0;
+      this->tail_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * push: Lgger till ett nytt element lngst bak i ringbufferten. Ifall det
+   *       finns plats returneras 0, annars felkod 1 (elementet kastas d).
+   *
+   *       - new_element: Referens till det nya element som ska lggas till.
+   ********************************************************************************/
+   int push(const T& new_element)
+   {
+      const uint8_t head = this->head_;
+      if (static_cast<uint8_t>(head - this->tail_) == N) return 1;
+      this->data_[head & MASK_] = new_element;
+      asm volatile("" ::: "memory");
+      this->head_ = head + 1;
+      return 0;
+   }
+
+   /********************************************************************************
+   * pop: Lser och tar bort det frsta elementet i ringbufferten. Ifall ett
+   *      element fanns att lsa returneras 0, annars felkod 1.
+   *
+   *      - element: Referens till variabel dr lst element ska lagras.
+   ********************************************************************************/
+   int pop(T& element)
+   {
+      const uint8_t tail = this->tail_;
+      if (tail == this->head_) return 1;
+      element = this->data_[tail & MASK_];
+      asm volatile("" ::: "memory");
+      this->tail_ = tail + 1;
+      return 0;
+   }
+
+   /********************************************************************************
+   * peek: Lser det frsta elementet i ringbufferten utan att ta bort det.
+   *       Ifall ett element fanns att lsa returneras 0, annars felkod 1.
+   *
+   *       - element: Referens till variabel dr lst element ska lagras.
+   ********************************************************************************/
+   int peek(T& element) const
+   {
+      const uint8_t tail = this->tail_;
+      if (tail == this->head_) return 1;
+      element = this->data_[tail & MASK_];
+      return 0;
+   }
+};
+
+#endif /* RING_BUFFER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,320 @@
+/********************************************************************************
+* serial.hpp: Innehller funktionalitet fr seriell verfring via USART0 med
+*             avbrottsstyrda ringbuffertar fr sndning och mottagning via
+*             den statiska klassen serial. Skrivning sker utan att vnta:
+*             tecken placeras i sndningsbufferten, varefter avbrottsrutinen
+*             fr USART_UDRE_vect skickar ett tecken i taget nr USART0 r
+*             redo. Drmed kan huvudprogrammet strmma mtvrden frn
+*             exempelvis timer-, adc- samt button-objekt vid hg verfrings-
+*             hastighet utan att blockeras.
+*
+*             Utsignalen ligger p pin 1 (PORTD1 / TXD) och insignalen p
+*             pin 0 (PORTD0 / RXD). Vid simulering (exempelvis simavr eller
+*             simulatorn i Microchip Studio) kan utskrifterna fljas via
+*             dataregistret UDR0, vilket gr att utskrifterna kan testas
+*             lokalt utan hrdvara.
+*
+*             Avbrottsvektorer:
+*
+*             Avbrottsvektor        Hndelse
+*             USART_UDRE_vect       Dataregistret r tomt (nsta tecken)
+*             USART_RX_vect         Ett tecken har tagits emot
+********************************************************************************/
+#ifndef SERIAL_HPP_
+#define SERIAL_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "ring_buffer.hpp"
+
+/********************************************************************************
+* serial: Statisk klass fr seriell verfring via USART0. Ifall sndnings-
+*         bufferten r full kastas utskriften i sin helhet, s att
+*         huvudprogrammet aldrig behver vnta och inga halva rader skickas.
+********************************************************************************/
+class serial
+{
+private:
+   static inline ring_buffer<uint8_t, 64> tx_;     /* Sndningsbuffert. */
+   static inline ring_buffer<uint8_t, 32> rx_;     /* Mottagningsbuffert. */
+   static inline volatile uint16_t tx_dropped_ = 0; /* Antal kastade utskrifter. */
+   static inline volatile uint16_t rx_dropped_ = 0; /* Antal kastade mottagna tecken. */
+
+   /********************************************************************************
+   * put: Lgger till ett tecken i sndningsbufferten. Ledigt utrymme mste
+   *      ha kontrollerats innan anrop.
+   *
+   *      - c: Tecknet som ska skickas.
+   ********************************************************************************/
+   static void put(const uint8_t c)
+   {
+      static_cast<void>(tx_.push(c));
+      return;
+   }
+
+   /********************************************************************************
+   * start_transmission: Aktiverar avbrott nr dataregistret r tomt, vilket
+   *                     startar sndning av tecken i sndningsbufferten.
+   ********************************************************************************/
+   static void start_transmission(void)
+   {
+      UCSR0B |= (1 << UDRIE0);
+      return;
+   }
+
+   /********************************************************************************
+   * drop: Rknar upp antalet kastade utskrifter och returnerar felkod 1.
+   ********************************************************************************/
+   static int drop(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      tx_dropped_++;
+      SREG = sreg;
+      return 1;
+   }
+
+   /********************************************************************************
+   * to_string: Omvandlar angivet tal till text i decimal form. Returnerar
+   *            antalet tecken, som lagras baklnges frn slutet av fltet.
+   *
+   *            - value : Talet som ska omvandlas.
+   *            - digits: Flt med plats fr minst tio tecken.
+   ********************************************************************************/
+   static uint8_t to_string(uint32_t value,
+                            char* digits)
+   {
+      uint8_t length = 0;
+
+      do
+      {
+         digits[9 - length++] = '0' + static_cast<char>(value % 10);
+         value /= 10;
+      } while (value);
+
+      return length;
+   }
+
+public:
+
+   /********************************************************************************
+   * init: Initierar USART0 fr sndning och mottagning med tta databitar,
+   *       ingen paritetsbit och en stoppbit (8N1). Dubbel verfrings-
+   *       hastighet (U2X0) anvnds, vilket ger lgre avvikelse vid hga
+   *       verfringshastigheter.
+   *
+   *       - baud_rate: verfringshastighet i bitar per sekund
+   *                    (default = 115 200).
+   ********************************************************************************/
+   static void init(const uint32_t baud_rate = 115200)
+   {
+      UCSR0A = (1 << U2X0);
+      UBRR0 = static_cast<uint16_t>((F_CPU + 4 * baud_rate) / (8 * baud_rate) - 1);
+      UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+      UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+      asm("SEI");
+      return;
+   }
+
+   /********************************************************************************
+   * write: Placerar ett tecken i sndningsbufferten. Ifall det finns plats
+   *        returneras 0, annars felkod 1.
+   *
+   *        - c: Tecknet som ska skickas.
+   ********************************************************************************/
+   static int write(const uint8_t c)
+   {
+      if (tx_.push(c)) return drop();
+      start_transmission();
+      return 0;
+   }
+
+   /********************************************************************************
+   * print: Placerar angiven text i sndningsbufferten. Ifall hela texten fr
+   *        plats returneras 0, annars kastas texten och felkod 1 returneras.
+   *
+   *        - s: Pekare till den nollterminerade text som ska skickas.
+   ********************************************************************************/
+   static int print(const char* s)
+   {
+      uint8_t length = 0;
+      while (s[length] && length < tx_.capacity()) length++;
+      if (s[length] || length > free_space()) return drop();
+
+      for (uint8_t i = 0; i < length; ++i)
+      {
+         put(static_cast<uint8_t>(s[i]));
+      }
+
+      start_transmission();
+      return 0;
+   }
+
+   /********************************************************************************
+   * print: Placerar angivet tal i decimal form i sndningsbufferten. Ifall
+   *        talet fr plats returneras 0, annars felkod 1.
+   *
+   *        - value: Talet som ska skickas.
+   ********************************************************************************/
+   static int print(const uint32_t value)
+   {
+      char digits[10];
+      const uint8_t length = to_string(value, digits);
+      if (length > free_space()) return drop();
+
+      for (uint8_t i = 10 - length; i < 10; ++i)
+      {
+         put(static_cast<uint8_t>(digits[i]));
+      }
+
+      start_transmission();
+      return 0;
+   }
+
+   /********************************************************************************
+   * print_value: Placerar en rad p formen "label=value" fljt av radbrytning
+   *              i sndningsbufferten, exempelvis fr att strmma en timers
+   *              rknare eller ett AD-omvandlat vrde. Raden skickas i sin
+   *              helhet eller inte alls. Vid lyckad placering returneras 0,
+   *              annars felkod 1.
+   *
+   *              - label: Pekare till nollterminerad benmning p vrdet.
+   *              - value: Vrdet som ska skickas.
+   ********************************************************************************/
+   static int print_value(const char* label,
+                          const uint32_t value)
+   {
+      char digits[10];
+      const uint8_t length = to_string(value, digits);
+      uint8_t label_length = 0;
+      while (label[label_length] && label_length < tx_.capacity()) label_length++;
+
+      if (static_cast<uint16_t>(label_length) + length + 3 > free_space()) return drop();
+
+      for (uint8_t i = 0; i < label_length; ++i)
+      {
+         put(static_cast<uint8_t>(label[i]));
+      }
+
+      put('=');
+
+      for (uint8_t i = 10 - length; i < 10; ++i)
+      {
+         put(static_cast<uint8_t>(digits[i]));
+      }
+
+      put('\r');
+      put('\n');
+      start_transmission();
+      return 0;
+   }
+
+   /********************************************************************************
+   * read: Lser det ldsta mottagna tecknet. Ifall ett tecken fanns
+   *       returneras 0, annars felkod 1.
+   *
+   *       - c: Referens till variabel dr mottaget tecken lagras.
+   ********************************************************************************/
+   static int read(uint8_t& c)
+   {
+      return rx_.pop(c);
+   }
+
+   /********************************************************************************
+   * available: Returnerar antalet mottagna tecken som vntar p att lsas.
+   ********************************************************************************/
+   static uint8_t available(void)
+   {
+      return rx_.size();
+   }
+
+   /********************************************************************************
+   * free_space: Returnerar antalet lediga platser i sndningsbufferten.
+   ********************************************************************************/
+   static uint8_t free_space(void)
+   {
+      return tx_.capacity() - tx_.size();
+   }
+
+   /********************************************************************************
+   * capacity: Returnerar sndningsbuffertens storlek, dvs. den lngsta text
+   *           som kan skickas i en utskrift.
+   ********************************************************************************/
+   static uint8_t capacity(void)
+   {
+      return tx_.capacity();
+   }
+
+   /********************************************************************************
+   * pending: Returnerar antalet tecken som vntar p att skickas.
+   ********************************************************************************/
+   static uint8_t pending(void)
+   {
+      return tx_.size();
+   }
+
+   /********************************************************************************
+   * tx_dropped: Returnerar antalet utskrifter som har kastats p grund av
+   *             full sndningsbuffert.
+   ********************************************************************************/
+   static uint16_t tx_dropped(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t dropped = tx_dropped_;
+      SREG = sreg;
+      return dropped;
+   }
+
+   /********************************************************************************
+   * rx_dropped: Returnerar antalet mottagna tecken som har kastats p grund
+   *             av full mottagningsbuffert.
+   ********************************************************************************/
+   static uint16_t rx_dropped(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t dropped = rx_dropped_;
+      SREG = sreg;
+      return dropped;
+   }
+
+   /********************************************************************************
+   * on_data_register_empty: Skickar nsta tecken i sndningsbufferten. Nr
+   *                         bufferten r tom inaktiveras avbrottet. Ska
+   *                         anropas frn avbrottsrutinen fr USART_UDRE_vect.
+   ********************************************************************************/
+   static void on_data_register_empty(void)
+   {
+      uint8_t c;
+
+      if (tx_.pop(c))
+      {
+         UCSR0B &= ~(1 << UDRIE0);
+      }
+      else
+      {
+         UDR0 = c;
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * on_receive: Lagrar mottaget tecken i mottagningsbufferten. Ska anropas
+   *             frn avbrottsrutinen fr USART_RX_vect.
+   ********************************************************************************/
+   static void on_receive(void)
+   {
+      const uint8_t c = UDR0;
+
+      if (rx_.push(c))
+      {
+         rx_dropped_++;
+      }
+
+      return;
+   }
+};
+
+#endif /* SERIAL_HPP_ */
\ No newline at end of file
@@ -1,12 +1,10 @@
 /********************************************************************************
 * setup.cpp: Innehller funktionalitet fr initiering av det inbyggda systemet.
-*            Lysdioder initieras p pin 8 - 9, tryckknappar initieras med 
-*            aktiverade PCI-avbrott p pin 12 - 13 och samtliga timerkretsar 
-*            initieras, dr timer 0 stts till att lpa ut efter 300 ms (fr att 
-*            temporrt inaktivera PCI-avbrott p I/O-port B efter nedtryckning 
-*            fr att undvika multipla avbrott orsakat av kontaktstudsar, medan 
-*            timer 1 - 2 stts till att lpa ut efter 100 ms (fr blinkning via 
-*            toggling av lysdioder).
+*            Lysdioder initieras p pin 8 - 9, tryckknappar initieras p
+*            pin 12 - 13 och avlses av detektorer som drivs av den delade
+*            ticken (fr avstudsning utan att PCI-avbrott behver stngas av),
+*            medan timer 1 - 2 stts till att lpa ut efter 100 ms (fr
+*            blinkning via toggling av lysdioder).
 ********************************************************************************/
 #include "header.hpp"
 
@@ -15,18 +13,29 @@ led l1(8);
 led l2(9);    
 
 button b1(12);
-button b2(13);   
-
-timer t0(timer::sel::timer0, 300); 
-timer t1(timer::sel::timer1, 100);
-timer t2(timer::sel::timer2, 100);
+button b2(13);   
+
+button_event_queue button_events;
+button_event_detector d1(b1, button_events);
+button_event_detector d2(b2, button_events);
+
+timer_for<100> t1(timer::sel::timer1, t1_elapsed);
+timer_for<100> t2(timer::sel::timer2, t2_elapsed);
 
 /********************************************************************************
 * setup: Initierar det inbyggda systemet. 
 ********************************************************************************/
 void setup(void)
 {
-   b1.enable_interrupt();
-   b2.enable_interrupt();
+   memory::paint();
+   serial::init();
+   trace::init();
+   cpu_load::init();
+
+   /* Timerkretsarnas tickar ska rymmas inom en fjrdedel av tiden mellan
+      tickarna: */
+   isr_policy::set_policy(isr_policy::vector::timer1_compa, isr_policy::policy::blocking, 32);
+   isr_policy::set_policy(isr_policy::vector::timer2_ovf, isr_policy::policy::blocking, 32);
+   isr_policy::set_policy(isr_policy::vector::timer2_compa, isr_policy::policy::blocking, 32);
    return;
 }
\ No newline at end of file
@@ -1,49 +1,186 @@
 /********************************************************************************
 * timer.hpp: Innehller funktionalitet fr implementering av interruptbaserade
 *            timerkretsar via klassen timer. Dessa timerkretsar fungerar ocks 
-*            utmrkt att anvnda som rknare.
+*            utmrkt att anvnda som rknare. Fr rkning av externa pulser
+*            i hrdvara, se klassen event_counter.
+*
+*            Klassen hller reda p vilket timer-objekt som ger respektive
+*            timerkrets. Ifall en upptagen timerkrets begrs, eller samtliga
+*            timerkretsar r upptagna vid val av sel::automatic, blir timern
+*            i stllet en mjukvarutimer. Mjukvarutimrar rknas upp frn en
+*            delad tick var 0.128:e millisekund via compare match A p
+*            Timer 2, dvs. samma takt som timerkretsarna. Drmed kan
+*            bibliotek begra timrar utan global samordning, samtidigt som
+*            timerkretsar anvnds s lnge sdana finns lediga.
+*
+*            Ifall en callbackrutin anges anropas denna frn avbrottsrutinen
+*            nr timern lper ut, oavsett ifall timern r en timerkrets eller
+*            en mjukvarutimer. Avbrottsrutinerna ska anropa on_interrupt med
+*            aktuell timerkrets samt on_shared_tick fr den delade ticken:
+*
+*            Avbrottsvektor        Anrop
+*            TIMER0_OVF_vect       timer::on_interrupt(timer::sel::timer0)
+*            TIMER1_COMPA_vect     timer::on_interrupt(timer::sel::timer1)
+*            TIMER2_OVF_vect       timer::on_interrupt(timer::sel::timer2)
+*            TIMER2_COMPA_vect     timer::on_shared_tick()
+*
+*            Rknarens bredd vljs vid kompilering via klassmallen
+*            basic_timer, dr timer utgr en timer med 32-bitars rknare.
+*            Via timer_for vljs minsta rknarbredd (8, 16 eller 32 bitar)
+*            fr angiven tid, exempelvis timer_for<300> fr 300 ms, vilket
+*            ger kortare avbrottsrutiner samt mindre RAM per timer. Tiden
+*            anges d endast som mallparameter, s att perioden alltid
+*            ryms i rknaren.
 ********************************************************************************/
 #ifndef TIMER_HPP_
 #define TIMER_HPP_
 
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
+#include "fixed.hpp"
+
+/* Frdeklaration av klassmall fr timrar med angiven rknarbredd: */
+template<class counter_t>
+class basic_timer;
 
 /********************************************************************************
-* timer: Klass fr implementering av interruptbaserade timerkretsar, som vid
-*        behov kan anvndas som rknare.
+* timer_base: Basklass fr timrar, som hller reda p timerkretsar, avbrott,
+*             callbackrutiner, kedjor samt den delade ticken oberoende av
+*             rknarens bredd. Rkningen implementeras av klassmallen
+*             basic_timer, dr rtt instans vljs via rknarens bredd i
+*             stllet fr via virtuella funktioner. Drmed behvs ingen
+*             vtabell i RAM och anropen frn avbrottsrutinerna kan inlinas.
 ********************************************************************************/
-class timer
+class timer_base
 {
 public:
-   enum class sel; /* Frdeklaration av enumerationsklass fr val av timerkrets. */
-private:
-   volatile uint32_t counter_ = 0;                            /* 32-bitars rknare. */
-   uint32_t max_count_ = 0;                                   /* Maxvrde som upprkning ska ske till. */
+   enum class sel;    /* Frdeklaration av enumerationsklass fr val av timerkrets. */
+   enum class action; /* Frdeklaration av enumerationsklass fr kedjade tgrder. */
+   typedef void (*callback)(void); /* Callbackrutin, anropas nr timern lper ut. */
+protected:
    sel timer_sel_ = sel::none;                                /* Val av timerkrets. */
+   uint8_t width_ = 0;                                        /* Rknarens bredd i byte (1, 2 eller 4). */
    bool interrupt_enabled_ = false;                           /* Indikerar ifall timergenererat avbrott r aktiverat. */
+   callback callback_ = nullptr;                              /* Callbackrutin vid utlpt timer. */
+   timer_base* chain_target_ = nullptr;                       /* Timer som pverkas vid utlpt timer. */
+   action chain_action_ = action::none;                       /* tgrd p kedjad timer. */
+   timer_base* next_ = nullptr;                               /* Nsta mjukvarutimer i listan. */
+   uint16_t slack_ = 0;                                       /* Tillten frdrjning av utlpning (tickar). */
    static constexpr auto TIME_BETWEEN_INTERRUPTS_MS_ = 0.128; /* 0.128 ms mellan varje timergenererat avbrott. */
+   static inline timer_base* owners_[3] = { };                /* gare av respektive timerkrets. */
+   static inline timer_base* software_timers_ = nullptr;      /* Lista med mjukvarutimrar. */
+   static inline volatile uint32_t ticks_ = 0;                /* Antal delade tickar sedan start. */
+   static inline bool shared_tick_blocked_ = false;           /* Indikerar ifall Timer 2 r reserverad fr annat. */
+   static constexpr uint8_t FRACTION_BITS_ = 16;              /* Antal brkbitar fr brkdelen. */
+   static constexpr uint32_t FRACTION_ONE_ = 1UL << FRACTION_BITS_; /* Ett helt avbrott i brkdelen. */
+
+   /********************************************************************************
+   * get_max_count: Returnerar heltalsdelen av antalet timergenererade avbrott
+   *                som krvs fr angiven tid. Brkdelen lagras med 16 brkbitar.
+   *
+   *                - time_ms : nskad tid mtt i millisekunder.
+   *                - fraction: Referens till variabel dr brkdelen lagras.
+   ********************************************************************************/
+   static inline uint32_t get_max_count(const double time_ms,
+                                        uint32_t& fraction)
+   {
+      fraction = 0;
+      if (time_ms <= 0) return 0;
+      const double interrupts = time_ms / TIME_BETWEEN_INTERRUPTS_MS_;
+      uint32_t integer = static_cast<uint32_t>(interrupts);
+      fraction = static_cast<uint32_t>((interrupts - integer) * FRACTION_ONE_ + 0.5);
+
+      if (fraction >= FRACTION_ONE_)
+      {
+         fraction -= FRACTION_ONE_;
+         integer++;
+      }
+
+      return integer;
+   }
+
+   /********************************************************************************
+   * get_max_count: Returnerar heltalsdelen av antalet timergenererade avbrott
+   *                som krvs fr angiven tid i fixpunktsformat. Eftersom
+   *                0.128 ms = 16 / 125 ms motsvarar tiden time_ms * 125 / 16
+   *                avbrott, vilket berknas enbart med 32-bitars heltal genom
+   *                att heltals- och brkdelen av tiden multipliceras var fr
+   *                sig. Med 16 brkbitar i tiden blir brkdelen av antalet
+   *                avbrott exakt med 20 brkbitar, vilken avrundas till 16
+   *                brkbitar. Avrundningen ger hgst 2^-17 avbrott (1 ns)
+   *                fel per period.
+   *
+   *                - time_ms : nskad tid mtt i millisekunder.
+   *                - fraction: Referens till variabel dr brkdelen lagras.
+   ********************************************************************************/
+   static inline uint32_t get_max_count(const q16_16 time_ms,
+                                        uint32_t& fraction)
+   {
+      fraction = 0;
+      if (time_ms.raw() <= 0) return 0;
+      const uint32_t integer = (static_cast<uint32_t>(time_ms.raw()) >> 16) * 125;
+      const uint32_t sum = ((integer & 0x0F) << 16) + (static_cast<uint32_t>(time_ms.raw()) & 0xFFFF) * 125 + 8;
+      fraction = (sum >> 4) & (FRACTION_ONE_ - 1);
+      return (integer >> 4) + (sum >> 20);
+   }
+
+   /********************************************************************************
+   * get_max_count: Returnerar heltalsdelen av antalet timergenererade avbrott
+   *                som krvs fr angiven tid i hela millisekunder, dvs.
+   *                time_ms * 125 / 16 avbrott. Berkningen grs enbart med
+   *                32-bitars heltal och r exakt, utan begrnsningen till
+   *                32 767 ms som gller fr fixpunktsformatet. Ifall antalet
+   *                avbrott inte ryms i 32 bitar returneras UINT32_MAX.
+   *
+   *                - time_ms : nskad tid mtt i millisekunder.
+   *                - fraction: Referens till variabel dr brkdelen lagras.
+   ********************************************************************************/
+   static inline uint32_t get_max_count(const uint32_t time_ms,
+                                        uint32_t& fraction)
+   {
+      fraction = 0;
+      if (time_ms > 549755813UL) return UINT32_MAX;
+      const uint32_t low = (time_ms & 0x0F) * 125;
+      fraction = (low & 0x0F) << (FRACTION_BITS_ - 4);
+      return (time_ms >> 4) * 125 + (low >> 4);
+   }
 
    /********************************************************************************
-   * get_max_count: Returnerar antalet timergenererade avbrott som krvs fr
-   *                angiven tid, avrundad till nrmaste heltal.
+   * get_max_count: Returnerar heltalsdelen av antalet timergenererade avbrott
+   *                fr en tid angiven med vriga taltyper. Heltal berknas
+   *                utan flyttal, medan flyttal (exempelvis float) omvandlas
+   *                till double. Negativa tider ger noll avbrott.
    *
-   *                - time_ms: nskad tid mtt i millisekunder.
+   *                - time_ms : nskad tid mtt i millisekunder.
+   *                - fraction: Referens till variabel dr brkdelen lagras.
    ********************************************************************************/
-   static inline uint32_t get_max_count(const double time_ms)
+   template<class T>
+   static inline uint32_t get_max_count(const T time_ms,
+                                        uint32_t& fraction)
    {
-      return static_cast<uint32_t>(time_ms / timer::TIME_BETWEEN_INTERRUPTS_MS_ + 0.5);
+      if constexpr (static_cast<T>(1) / static_cast<T>(2) == 0)
+      {
+         return get_max_count(static_cast<uint32_t>(time_ms > 0 ? time_ms : 0), fraction);
+      }
+      else
+      {
+         return get_max_count(static_cast<double>(time_ms), fraction);
+      }
    }
 
    /********************************************************************************
    * init_circuit: Initierar angiven timerkrets. Timer 0 samt Timer 2 initieras 
-   *               i Normal Mode, medan Timer 1 initieras i CTC Mode med upprkning 
-   *               till 256. Vid aktiverat avbrott p godtycklig initierad timer 
-   *               sker timergenererat avbrott var 0.128:e millisekund.
+   *               i Normal Mode, medan Timer 1 initieras i CTC Mode med 256
+   *               steg per period (0 - 255, dvs. OCR1A = 255). Vid aktiverat
+   *               avbrott p godtycklig initierad timer sker timergenererat
+   *               avbrott var 0.128:e millisekund. Fr mjukvarutimrar startas
+   *               den delade ticken. Vid lyckad initiering returneras 0.
+   *               Ifall den delade ticken inte kan startas returneras
+   *               felkod 1.
    *
    *               - timer_sel: Timerkretsen som ska initieras.
    ********************************************************************************/
-   static void init_circuit(const sel timer_sel)
+   static int init_circuit(const sel timer_sel)
    {
       if (timer_sel == sel::timer0)
       {
@@ -52,59 +189,253 @@ private:
       else if (timer_sel == sel::timer1)
       {
          TCCR1B = (1 << CS11) | (1 << WGM12);
-         OCR1A = 256;
+         OCR1A = 255;
       }
       else if (timer_sel == sel::timer2)
       {
          TCCR2B = (1 << CS21);
       }
+      else if (timer_sel == sel::software)
+      {
+         if (start_shared_tick()) return 1;
+      }
 
       asm("SEI");
-      return;
+      return 0;
    }
 
-public:
+   /********************************************************************************
+   * allocate: Tilldelar angiven timer en timerkrets och returnerar vald
+   *           timerkrets. Vid sel::automatic vljs frsta lediga timerkrets
+   *           i ordningen Timer 2, Timer 0, Timer 1, s att 16-bitars
+   *           Timer 1 sparas till sist. Ifall ingen lmplig timerkrets r
+   *           ledig blir timern en mjukvarutimer.
+   *
+   *           - owner    : Timern som ska tilldelas en timerkrets.
+   *           - requested: Begrd timerkrets.
+   ********************************************************************************/
+   static sel allocate(timer_base* owner,
+                       const sel requested)
+   {
+      if (requested == sel::none) return sel::none;
+      sel result = sel::software;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (requested == sel::automatic)
+      {
+         static constexpr sel order[] = { sel::timer2, sel::timer0, sel::timer1 };
+
+         for (const auto i : order)
+         {
+            if (!owners_[static_cast<uint8_t>(i)])
+            {
+               result = i;
+               break;
+            }
+         }
+      }
+      else if (requested != sel::software && !owners_[static_cast<uint8_t>(requested)])
+      {
+         result = requested;
+      }
+
+      if (result == sel::software)
+      {
+         owner->next_ = software_timers_;
+         software_timers_ = owner;
+      }
+      else
+      {
+         owners_[static_cast<uint8_t>(result)] = owner;
+      }
+
+      SREG = sreg;
+      return result;
+   }
 
    /********************************************************************************
-   * timer: Initierar ny timerkrets med angiven tid mtt i millisekunder.
+   * release: Frigr timerkretsen som gs av angiven timer, alternativt tar
+   *          bort timern frn listan med mjukvarutimrar.
    *
-   *        - timer_sel: Val av timerkrets.
-   *        - time_ms  : Tiden timern ska sttas p mtt i millisekunder.
+   *          - owner: Timern som ska frigras.
    ********************************************************************************/
-   timer(const sel timer_sel, 
-         const double time_ms)
+   static void release(timer_base* owner)
    {
-      this->timer_sel_ = timer_sel;
-      this->max_count_ = this->get_max_count(time_ms);
-      this->init_circuit(this->timer_sel_);
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (owner->timer_sel_ == sel::software)
+      {
+         for (timer_base** i = &software_timers_; *i; i = &(*i)->next_)
+         {
+            if (*i == owner)
+            {
+               *i = owner->next_;
+               break;
+            }
+         }
+      }
+      else if (owner->timer_sel_ != sel::none && owners_[static_cast<uint8_t>(owner->timer_sel_)] == owner)
+      {
+         owners_[static_cast<uint8_t>(owner->timer_sel_)] = nullptr;
+      }
+
+      owner->next_ = nullptr;
+      SREG = sreg;
       return;
    }
 
    /********************************************************************************
-   * ~timer: Stnger av angiven timerkrets innan den raderas. 
+   * move_to_shared_tick: Flyttar angiven timer frn sin timerkrets till den
+   *                      delade ticken. Timerkretsens avbrott inaktiveras och
+   *                      timerkretsen frigrs, medan rknare, period samt
+   *                      aktivering behlls, eftersom tiden mellan avbrotten
+   *                      r densamma. Vid lyckad flytt, eller ifall timern
+   *                      redan r en mjukvarutimer, returneras 0. Ifall den
+   *                      delade ticken inte kan startas, eller timern saknar
+   *                      timerkrets, returneras felkod 1 och timern lmnas
+   *                      ofrndrad.
    ********************************************************************************/
-   ~timer(void)
+   int move_to_shared_tick(void)
    {
-      this->reset();
+      if (this->timer_sel_ == sel::software) return 0;
+      if (this->timer_sel_ == sel::none || start_shared_tick()) return 1;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const bool enabled = this->interrupt_enabled_;
+      this->disable_interrupt();
+      release(this);
+      this->timer_sel_ = sel::software;
+      this->next_ = software_timers_;
+      software_timers_ = this;
+      this->interrupt_enabled_ = enabled;
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * expire: Anropar eventuell callbackrutin, fljt av eventuell kedjad tgrd.
+   ********************************************************************************/
+   void expire(void)
+   {
+      if (this->callback_) this->callback_();
+      if (this->chain_target_) this->run_chain();
       return;
    }
 
    /********************************************************************************
-   * counter: Returnerar lagrat vrde frn angiven timers rknare.
+   * run_chain: Utfr kedjad tgrd p kedjad timer.
    ********************************************************************************/
-   uint32_t counter(void) const
+   void run_chain(void)
    {
-      return this->counter_;
+      timer_base& target = *this->chain_target_;
+
+      if (this->chain_action_ == action::arm)
+      {
+         target.enable_interrupt();
+      }
+      else if (this->chain_action_ == action::reload)
+      {
+         target.reload();
+         target.enable_interrupt();
+      }
+      else if (this->chain_action_ == action::disarm)
+      {
+         target.disable_interrupt();
+      }
+      else if (this->chain_action_ == action::cascade)
+      {
+         target.on_tick();
+      }
+
+      return;
    }
 
    /********************************************************************************
-   * max_cout: Returnerar det vrde som angiven timer ska rkna upp till.
+   * on_tick: Rknar upp angiven timer. Ifall timern har lpt ut anropas
+   *          eventuell callbackrutin, fljt av eventuell kedjad tgrd.
+   *          Returnerar true ifall timern lpte ut, annars false.
+   ********************************************************************************/
+   bool on_tick(void);
+
+   /********************************************************************************
+   * lateness: Returnerar antalet tickar som angiven timer har passerat sin
+   *           utlpning, alternativt -1 ifall timern inte har lpt ut.
+   ********************************************************************************/
+   int32_t lateness(void) const;
+
+   /********************************************************************************
+   * expire_late: Lter angiven timer lpa ut efter samordning, dr antalet
+   *              tickar som timern har passerat sin utlpning dras av frn
+   *              nsta period.
+   ********************************************************************************/
+   void expire_late(void);
+
+   /********************************************************************************
+   * reload: Startar om angiven timers period frn noll.
+   ********************************************************************************/
+   void reload(void);
+
+   /********************************************************************************
+   * count: Rknar upp angiven timer.
+   ********************************************************************************/
+   void count(void);
+
+   /********************************************************************************
+   * max_count: Returnerar det vrde som angiven timer ska rkna upp till.
+   ********************************************************************************/
+   uint32_t max_count(void) const;
+
+   /********************************************************************************
+   * as: Returnerar angiven timer som en timer med rknaren counter_t. Fr
+   *     endast anropas med den datatyp som motsvarar width_.
    ********************************************************************************/
-   uint32_t max_count(void) const
+   template<class counter_t>
+   basic_timer<counter_t>& as(void)
    {
-      return this->max_count_;
+      return static_cast<basic_timer<counter_t>&>(*this);
    }
 
+   /********************************************************************************
+   * as: Returnerar angiven timer som en konstant timer med rknaren counter_t.
+   ********************************************************************************/
+   template<class counter_t>
+   const basic_timer<counter_t>& as(void) const
+   {
+      return static_cast<const basic_timer<counter_t>&>(*this);
+   }
+
+   /********************************************************************************
+   * timer_base: Tilldelar ny timer angiven timerkrets. Ifall begrd
+   *             timerkrets r upptagen blir timern en mjukvarutimer.
+   *
+   *             - timer_sel: Val av timerkrets, alternativt sel::automatic.
+   *             - width    : Rknarens bredd i byte (1, 2 eller 4).
+   ********************************************************************************/
+   timer_base(const sel timer_sel,
+              const uint8_t width)
+      : width_(width)
+   {
+      this->timer_sel_ = allocate(this, timer_sel);
+      return;
+   }
+
+   /********************************************************************************
+   * ~timer_base: Frigr angiven timers timerkrets innan timern raderas.
+   ********************************************************************************/
+   ~timer_base(void)
+   {
+      release(this);
+      return;
+   }
+
+public:
+
+   /* Timern ger en timerkrets och kan drmed inte kopieras: */
+   timer_base(const timer_base&) = delete;
+   timer_base& operator=(const timer_base&) = delete;
+
    /********************************************************************************
    * timer_sel: Returnerar anvnd timerkrets via en enumerator av
    *            enumerationsklassen timer::sel.
@@ -114,6 +445,126 @@ public:
       return this->timer_sel_;
    }
 
+   /********************************************************************************
+   * reservable: Returnerar angiven timerkrets ifall den r ledig, annars
+   *             sel::none. Anvnds nr en timerkrets reserveras fr en annan
+   *             hrdvarufunktion, exempelvis pulsrkning, dr en mjukvarutimer
+   *             inte kan erstta timerkretsen. En upptagen timerkrets ger d
+   *             en timer utan timerkrets i stllet fr en mjukvarutimer,
+   *             vilket gr att reservationen misslyckas utan att den delade
+   *             ticken startas. Ska anropas frn huvudprogrammet.
+   *
+   *             - timer_sel: Timerkretsen som ska reserveras.
+   ********************************************************************************/
+   static sel reservable(const sel timer_sel)
+   {
+      if (timer_sel != sel::timer0 && timer_sel != sel::timer1 && timer_sel != sel::timer2) return sel::none;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const bool taken = owners_[static_cast<uint8_t>(timer_sel)] != nullptr;
+      SREG = sreg;
+      return taken ? sel::none : timer_sel;
+   }
+
+   /********************************************************************************
+   * hardware: Indikerar ifall angiven timer ger en timerkrets. Annars r
+   *           timern en mjukvarutimer, som rknas upp av den delade ticken.
+   ********************************************************************************/
+   bool hardware(void) const
+   {
+      return this->timer_sel_ == sel::timer0 || this->timer_sel_ == sel::timer1 ||
+             this->timer_sel_ == sel::timer2;
+   }
+
+   /********************************************************************************
+   * set_callback: Stter ny callbackrutin, som anropas frn avbrottsrutinen
+   *               nr timern lper ut.
+   *
+   *               - new_callback: Ny callbackrutin (nullptr = ingen).
+   ********************************************************************************/
+   void set_callback(const callback new_callback)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->callback_ = new_callback;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * chain: Kedjar angiven timer till en annan timer, s att angiven tgrd
+   *        utfrs p den andra timern varje gng angiven timer lper ut.
+   *        tgrden utfrs direkt i avbrottsrutinen, vilket gr att
+   *        sekvenser av tider inte krver ngon egen kod i avbrottsrutiner.
+   *        Exempelvis ger t0.chain(t0, timer::action::disarm) en timer som
+   *        endast lper ut en gng. Kedjade timrar mste leva minst lika
+   *        lnge som kedjan.
+   *
+   *        Fr mycket lnga tider kan timrar kaskadkopplas via
+   *        timer::action::cascade, dr den kedjade timern rknas upp en gng
+   *        per utlpt period. Den kedjade timern ska d vara en rknare
+   *        (sel::none) med maxvrde satt via set_max_count, exempelvis
+   *        24 fr ett dygn med en timer p en timme.
+   *
+   *        Vid lyckad kedjning returneras 0. Kaskadkoppling till en timer
+   *        med maxvrde 0 eller som skulle ge en sluten kaskad (exempelvis
+   *        till timern sjlv) avvisas med felkod 1, eftersom den kedjade
+   *        timern d skulle lpa ut rekursivt tills stacken tar slut.
+   *
+   *        - target      : Referens till timern som ska pverkas.
+   *        - chain_action: tgrd som ska utfras p den kedjade timern.
+   ********************************************************************************/
+   int chain(timer_base& target,
+             const action chain_action)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (chain_action == action::cascade)
+      {
+         if (target.max_count() == 0)
+         {
+            SREG = sreg;
+            return 1;
+         }
+
+         for (const timer_base* i = &target; i; i = i->chain_action_ == action::cascade ? i->chain_target_ : nullptr)
+         {
+            if (i == this)
+            {
+               SREG = sreg;
+               return 1;
+            }
+         }
+      }
+
+      this->chain_target_ = chain_action == action::none ? nullptr : &target;
+      this->chain_action_ = chain_action;
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * unchain: Tar bort eventuell kedja frn angiven timer.
+   ********************************************************************************/
+   void unchain(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->chain_target_ = nullptr;
+      this->chain_action_ = action::none;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * slack: Returnerar tillten frdrjning av utlpning i antalet tickar.
+   ********************************************************************************/
+   uint16_t slack(void) const
+   {
+      return this->slack_;
+   }
+
    /********************************************************************************
    * enabled: Indikerar ifall timergenererat avbrott r aktiverat p angiven timer.
    ********************************************************************************/
@@ -127,7 +578,7 @@ public:
    *                   rknar upp till overflow eller specificerat max.
    *
    *                   Timer 0 samt Timer 2 aktiveras i Normal Mode, medan Timer 1
-   *                   aktiveras i CTC Mode med upprkning till 256, vilket gr
+   *                   aktiveras i CTC Mode med 256 steg per period, vilket gr
    *                   att tiden mellan varje timergenererat avbrott r samma 
    *                   oavsett anvnd timerkrets.
    *
@@ -137,45 +588,57 @@ public:
    *                     Timer 0     TIMER0_OVF_vect
    *                     Timer 1     TIMER1_COMPA_vect
    *                     Timer 2     TIMER2_OVF_vect
+   *
+   *                   Fr mjukvarutimrar aktiveras i stllet upprkning via
+   *                   den delade ticken (TIMER2_COMPA_vect).
    ********************************************************************************/
    void enable_interrupt(void)
    {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
       if (this->timer_sel_ == sel::timer0)
       {
-          TIMSK0 = (1 << TOIE0);
+         TIMSK0 |= (1 << TOIE0);
       }
       else if (this->timer_sel_ == sel::timer1)
       {
-         TIMSK1 = (1 << OCIE1A);
+         TIMSK1 |= (1 << OCIE1A);
       }
       else if (this->timer_sel_ == sel::timer2)
       {
-         TIMSK2 = (1 << TOIE2);
+         TIMSK2 |= (1 << TOIE2);
       }
 
       this->interrupt_enabled_ = true;
+      SREG = sreg;
       return;
    }
 
    /********************************************************************************
    * disable_interrupt: Inaktiverar timergenererat avbrott p angiven timer.
+   *                    vriga avbrott p timerkretsen pverkas inte.
    ********************************************************************************/
    void disable_interrupt(void)
    {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
       if (this->timer_sel_ == sel::timer0)
       {
-         TIMSK0 = 0;
+         TIMSK0 &= ~(1 << TOIE0);
       }
       else if (this->timer_sel_ == sel::timer1)
       {
-         TIMSK1 = 0;
+         TIMSK1 &= ~(1 << OCIE1A);
       }
       else if (this->timer_sel_ == sel::timer2)
       {
-         TIMSK2 = 0;
+         TIMSK2 &= ~(1 << TOIE2);
       }
 
       this->interrupt_enabled_ = false;
+      SREG = sreg;
       return;
    }
 
@@ -198,6 +661,422 @@ public:
       return;
    }
 
+   /********************************************************************************
+   * start_shared_tick: Startar den delade ticken via compare match A p
+   *                    Timer 2, vilket sker var 0.128:e millisekund. Timer 2
+   *                    startas ifall den inte redan lper. Anropas automatiskt
+   *                    nr en mjukvarutimer skapas. Vid lyckad start (eller
+   *                    ifall ticken redan lper) returneras 0. Ifall Timer 2
+   *                    r reserverad via block_shared_tick returneras felkod 1.
+   ********************************************************************************/
+   static int start_shared_tick(void)
+   {
+      if (shared_tick_blocked_) return 1;
+
+      if ((TCCR2B & 0x07) == 0)
+      {
+         TCCR2B = (1 << CS21);
+      }
+
+      if (!(TIMSK2 & (1 << OCIE2A)))
+      {
+         OCR2A = 0;
+         TIFR2 = (1 << OCF2A);
+         TIMSK2 |= (1 << OCIE2A);
+      }
+
+      asm("SEI");
+      return 0;
+   }
+
+   /********************************************************************************
+   * block_shared_tick: Reserverar Timer 2 fr en annan hrdvarufunktion,
+   *                    exempelvis frekvensgenerering, s att efterfljande
+   *                    anrop av start_shared_tick misslyckas i stllet fr
+   *                    att ndra timerkretsens instllningar. Vid lyckad
+   *                    reservation returneras 0. Ifall den delade ticken
+   *                    redan lper returneras felkod 1.
+   ********************************************************************************/
+   static int block_shared_tick(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (TIMSK2 & (1 << OCIE2A))
+      {
+         SREG = sreg;
+         return 1;
+      }
+
+      shared_tick_blocked_ = true;
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * unblock_shared_tick: Frigr Timer 2 efter block_shared_tick, s att den
+   *                      delade ticken kan startas igen.
+   ********************************************************************************/
+   static void unblock_shared_tick(void)
+   {
+      shared_tick_blocked_ = false;
+      return;
+   }
+
+   /********************************************************************************
+   * ticks: Returnerar antalet delade tickar  0.128 ms sedan den delade
+   *        ticken startades.
+   ********************************************************************************/
+   static uint32_t ticks(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint32_t ticks = ticks_;
+      SREG = sreg;
+      return ticks;
+   }
+
+   /********************************************************************************
+   * timestamp: Returnerar en lpande tidsstmpel med upplsningen 0.5 s
+   *            (8 klockcykler), bestende av den delade ticken samt aktuellt
+   *            vrde p Timer 2. Tidsstmpeln slr runt efter cirka 35
+   *            minuter, men differensen mellan tv tidsstmplar blir korrekt
+   *            ven vid runtslag. Den delade ticken mste vara startad.
+   ********************************************************************************/
+   static uint32_t timestamp(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      uint32_t ticks = ticks_;
+      const uint8_t count = TCNT2;
+
+      if ((TIFR2 & (1 << OCF2A)) && count < 128)
+      {
+         ticks++;
+      }
+
+      SREG = sreg;
+      return (ticks << 8) | count;
+   }
+
+   /********************************************************************************
+   * on_interrupt: Rknar upp timern som ger angiven timerkrets och anropar
+   *               dess callbackrutin ifall timern har lpt ut. Ska anropas
+   *               frn timerkretsens avbrottsrutin.
+   *
+   *               - timer_sel: Timerkretsen som avbrottet gde rum p.
+   ********************************************************************************/
+   static void on_interrupt(const sel timer_sel)
+   {
+      timer_base* owner = owners_[static_cast<uint8_t>(timer_sel)];
+      if (owner) owner->on_tick();
+      return;
+   }
+
+   /********************************************************************************
+   * on_shared_tick: Rknar upp den delade ticken samt samtliga aktiverade
+   *                 mjukvarutimrar. Timrar utan slack lper ut direkt. Utlpta
+   *                 timrar med slack vntar tills ngon annan timer lper ut
+   *                 eller tills tillten frdrjning har passerats, varvid
+   *                 samtliga vntande timrar lper ut p samma tick. Ska
+   *                 anropas frn avbrottsrutinen fr TIMER2_COMPA_vect.
+   ********************************************************************************/
+   static void on_shared_tick(void)
+   {
+      ticks_++;
+      bool expired = false;
+
+      for (timer_base* i = software_timers_; i; i = i->next_)
+      {
+         if (!i->interrupt_enabled_) continue;
+
+         if (i->slack_ == 0 || (!i->callback_ && !i->chain_target_))
+         {
+            if (i->on_tick()) expired = true;
+         }
+         else
+         {
+            i->count();
+            if (i->lateness() >= i->slack_) expired = true;
+         }
+      }
+
+      if (!expired) return;
+
+      for (timer_base* i = software_timers_; i; i = i->next_)
+      {
+         if (i->interrupt_enabled_ && i->slack_ && (i->callback_ || i->chain_target_) &&
+             i->lateness() >= 0)
+         {
+            i->expire_late();
+         }
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * sel: Enumeration fr val av timerkrets.
+   ********************************************************************************/
+   enum class sel
+   {
+      timer0,    /* Timer 0. */
+      timer1,    /* Timer 1. */
+      timer2,    /* Timer 2. */
+      automatic, /* Frsta lediga timerkrets, annars mjukvarutimer. */
+      software,  /* Mjukvarutimer p den delade ticken. */
+      none       /* Timer ospecificerad. */
+   };
+
+   /********************************************************************************
+   * action: Enumeration fr tgrder som kan utfras p en kedjad timer.
+   ********************************************************************************/
+   enum class action
+   {
+      none,   /* Ingen tgrd. */
+      arm,    /* Aktivera den kedjade timern. */
+      reload, /* Starta om den kedjade timerns period och aktivera den. */
+      disarm, /* Inaktivera den kedjade timern. */
+      cascade /* Rkna upp den kedjade timern en gng (kaskadkoppling). */
+   };
+};
+
+/********************************************************************************
+* basic_timer: Klassmall fr interruptbaserade timerkretsar, som vid behov kan
+*              anvndas som rknare, dr counter_t utgr rknarens datatyp
+*              (uint8_t, uint16_t eller uint32_t). En smalare rknare ger
+*              frre instruktioner vid varje tick samt mindre RAM per timer,
+*              men begrnsar lngsta period till 2^(8 * sizeof(counter_t)) - 2
+*              avbrott, dvs. cirka 32 ms fr 8 bitar och 8.4 s fr 16 bitar.
+********************************************************************************/
+template<class counter_t>
+class basic_timer : public timer_base
+{
+   static_assert(static_cast<counter_t>(-1) > 0 && sizeof(counter_t) != 8,
+                 "Rknaren mste utgras av uint8_t, uint16_t eller uint32_t!");
+   friend class timer_base;
+private:
+   volatile counter_t counter_ = 0;                           /* Rknare. */
+   counter_t max_count_ = 0;                                  /* Maxvrde som upprkning ska ske till. */
+   uint16_t fraction_ = 0;                                    /* Brkdel av avbrott per period (2^-16). */
+   uint16_t remainder_ = 0;                                   /* Ackumulerad brkdel (2^-16). */
+   uint8_t carry_ = 0;                                        /* Extra avbrott i aktuell period (0 - 1). */
+   static constexpr counter_t MAX_VALUE_ = static_cast<counter_t>(-1); /* Rknarens hgsta vrde. */
+   static constexpr counter_t MAX_COUNT_ = MAX_VALUE_ - 1;    /* Hgsta maxvrde, med plats fr extra avbrott. */
+
+   /********************************************************************************
+   * set_period: Stter ny period fr angiven timer, dr brkdelen av antalet
+   *             avbrott ackumuleras mellan varje period (Bresenham). Perioder
+   *             om max_count respektive max_count + 1 avbrott varvas s att
+   *             medelperioden blir exakt, vilket gr att periodiska timrar
+   *             inte driver ivg ver tid. Frsta perioden avrundas till
+   *             nrmaste heltal. Eventuell slack begrnsas p nytt mot den
+   *             nya perioden. Vid lyckad instllning returneras 0. Ifall
+   *             perioden inte ryms i rknaren returneras felkod 1, varvid
+   *             perioden lmnas ofrndrad.
+   *
+   *             - max_count: Heltalsdelen av antalet avbrott per period.
+   *             - fraction : Brkdelen av antalet avbrott per period.
+   ********************************************************************************/
+   int set_period(const uint32_t max_count,
+                  const uint32_t fraction)
+   {
+      if (max_count > MAX_COUNT_) return 1;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      this->max_count_ = static_cast<counter_t>(max_count);
+      this->fraction_ = static_cast<uint16_t>(fraction);
+      this->remainder_ = static_cast<uint16_t>(FRACTION_ONE_ / 2);
+      this->advance();
+      if (this->slack_ > this->max_slack()) this->slack_ = this->max_slack();
+      SREG = sreg;
+      return 0;
+   }
+
+   /********************************************************************************
+   * max_slack: Returnerar hgsta tilltna slack fr aktuell period, dvs. halva
+   *            perioden, dock hgst vad som ryms i rknaren ovanfr
+   *            maxvrdet, s att rknaren inte slr runt innan en frdrjd
+   *            timer lper ut.
+   ********************************************************************************/
+   uint16_t max_slack(void) const
+   {
+      const uint32_t headroom = MAX_VALUE_ - this->max_count_ - 1UL;
+      uint32_t max_slack = this->max_count_ / 2;
+      if (max_slack > headroom) max_slack = headroom;
+      if (max_slack > UINT16_MAX) max_slack = UINT16_MAX;
+      return static_cast<uint16_t>(max_slack);
+   }
+
+   /********************************************************************************
+   * advance: Adderar brkdelen till ackumulerad brkdel infr nsta period.
+   *          Ifall ackumulerad brkdel nr ett helt avbrott, dvs. slr runt
+   *          i 16 bitar, frlngs nsta period med ett avbrott.
+   ********************************************************************************/
+   void advance(void)
+   {
+      this->remainder_ += this->fraction_;
+      this->carry_ = this->remainder_ < this->fraction_ ? 1 : 0;
+      return;
+   }
+
+   /********************************************************************************
+   * on_tick: Rknar upp angiven timer. Ifall timern har lpt ut anropas
+   *          eventuell callbackrutin, fljt av eventuell kedjad tgrd.
+   *          Returnerar true ifall timern lpte ut, annars false.
+   ********************************************************************************/
+   bool on_tick(void)
+   {
+      this->count();
+
+      if ((this->callback_ || this->chain_target_) && this->elapsed())
+      {
+         this->expire();
+         return true;
+      }
+
+      return false;
+   }
+
+   /********************************************************************************
+   * lateness: Returnerar antalet tickar som angiven timer har passerat sin
+   *           utlpning, alternativt -1 ifall timern inte har lpt ut.
+   ********************************************************************************/
+   int32_t lateness(void) const
+   {
+      const uint32_t limit = static_cast<uint32_t>(this->max_count_) + this->carry_;
+      if (this->counter_ < limit) return -1;
+      return static_cast<int32_t>(this->counter_ - limit);
+   }
+
+   /********************************************************************************
+   * expire_late: Lter angiven timer lpa ut efter samordning. Antalet tickar
+   *              som timern har passerat sin utlpning behlls i rknaren, s
+   *              att nsta period frkortas lika mycket och medelperioden
+   *              frblir exakt.
+   ********************************************************************************/
+   void expire_late(void)
+   {
+      this->counter_ -= this->max_count_ + this->carry_;
+      this->advance();
+      this->expire();
+      return;
+   }
+
+   /********************************************************************************
+   * reload: Startar om angiven timers period frn noll.
+   ********************************************************************************/
+   void reload(void)
+   {
+      this->counter_ = 0;
+      this->set_period(this->max_count_, this->fraction_);
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * basic_timer: Initierar ny timerkrets med angiven tid mtt i milli-
+   *              sekunder. Tiden kan anges som heltal, i fixpunktsformat
+   *              (q16_16) eller som flyttal, dr endast flyttal krver att
+   *              flyttalsrutiner lnkas in. Ifall begrd timerkrets r
+   *              upptagen blir timern en mjukvarutimer. Ifall tiden inte
+   *              ryms i rknaren begrnsas den till rknarens strsta
+   *              period. Ifall en mjukvarutimer inte kan skapas, eftersom
+   *              Timer 2 r reserverad, blir timern utan timerkrets
+   *              (sel::none).
+   *
+   *              - timer_sel   : Val av timerkrets, alternativt sel::automatic.
+   *              - time_ms     : Tiden timern ska sttas p mtt i millisekunder.
+   *              - new_callback: Callbackrutin vid utlpt timer (default = ingen).
+   ********************************************************************************/
+   template<class T>
+   basic_timer(const sel timer_sel,
+               const T time_ms,
+               const callback new_callback = nullptr)
+      : timer_base(timer_sel, sizeof(counter_t))
+   {
+      uint32_t fraction;
+      const uint32_t max_count = get_max_count(time_ms, fraction);
+      if (this->set_period(max_count, fraction)) this->set_period(MAX_COUNT_, 0);
+      this->callback_ = new_callback;
+
+      if (this->init_circuit(this->timer_sel_))
+      {
+         release(this);
+         this->timer_sel_ = sel::none;
+      }
+
+      return;
+   }
+
+   /********************************************************************************
+   * ~basic_timer: Stnger av angiven timerkrets innan timern raderas.
+   *               Timerkretsen frigrs drefter av basklassen.
+   ********************************************************************************/
+   ~basic_timer(void)
+   {
+      this->reset();
+      return;
+   }
+
+   /********************************************************************************
+   * counter: Returnerar lagrat vrde frn angiven timers rknare.
+   ********************************************************************************/
+   counter_t counter(void) const
+   {
+      return this->counter_;
+   }
+
+   /********************************************************************************
+   * max_count: Returnerar det vrde som angiven timer ska rkna upp till.
+   ********************************************************************************/
+   counter_t max_count(void) const
+   {
+      return this->max_count_;
+   }
+
+   /********************************************************************************
+   * set_slack: Stter hur mnga tickar  0.128 ms som utlpningen av angiven
+   *            timer fr frdrjas. En utlpt timer med slack vntar tills
+   *            ngon annan mjukvarutimer lper ut, alternativt tills tillten
+   *            frdrjning har passerats, varefter samtliga vntande timrar
+   *            lper ut p samma tick. Drmed samlas callbackrutiner som
+   *            ligger nra varandra i tiden till samma tick. Frdrjningen
+   *            dras av frn nsta period, s att periodiska timrar inte
+   *            driver ivg ver tid.
+   *
+   *            En timer som tillter slack behver inte en egen timerkrets,
+   *            varfr en timer p Timer 0 - 2 flyttas till den delade
+   *            ticken och timerkretsens avbrott inaktiveras. Drmed
+   *            frsvinner en hel avbrottsklla (TIMER0_OVF_vect,
+   *            TIMER1_COMPA_vect eller TIMER2_OVF_vect), s att processorn
+   *            avbryts och vcks frre gnger nr den delade ticken nd
+   *            lper, exempelvis fr sprning. Timerkretsen frigrs och
+   *            kan reserveras av annan funktionalitet. Timern frblir
+   *            mjukvarutimer ven ifall slack senare stts till noll.
+   *
+   *            Slack pverkar endast timrar med callbackrutin eller kedja.
+   *            Frdrjningen begrnsas till halva perioden samt till vad
+   *            som ryms i rknaren, ven nr perioden ndras senare. Vid
+   *            lyckad instllning returneras 0. Ifall timern inte kan
+   *            flyttas till den delade ticken, eftersom Timer 2 r
+   *            reserverad eller timern saknar timerkrets, returneras
+   *            felkod 1, varvid timern lper ut utan frdrjning.
+   *
+   *            - slack_ticks: Tillten frdrjning i antalet tickar (0 = ingen).
+   ********************************************************************************/
+   int set_slack(const uint16_t slack_ticks)
+   {
+      if (slack_ticks && this->max_slack() && this->move_to_shared_tick()) return 1;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      const uint16_t max_slack = this->max_slack();
+      this->slack_ = slack_ticks > max_slack ? max_slack : slack_ticks;
+      SREG = sreg;
+      return 0;
+   }
+
    /********************************************************************************
    * count: Rknar upp angiven timer.
    ********************************************************************************/
@@ -210,13 +1089,15 @@ public:
    /********************************************************************************
    * elapsed: Indikerar ifall angiven timer har lpt ut genom att returnera true
    *          eller false. Ifall timern har lpt ut nollstlls rknaren infr
-   *          nsta upprkning.
+   *          nsta upprkning, varefter brkdelen ackumuleras infr nsta
+   *          period.
    ********************************************************************************/
    bool elapsed(void)
    {
-      if (this->counter_ >= this->max_count_)
+      if (this->counter_ >= this->max_count_ + this->carry_)
       {
          this->counter_ = 0;
+         this->advance();
          return true;
       }
       else
@@ -232,42 +1113,164 @@ public:
     {
        this->disable_interrupt();
        this->counter_ = 0;
+       this->set_period(this->max_count_, this->fraction_);
        return;
     }
 
    /********************************************************************************
-   * set_time_ms: Stter ny tid p angiven timerkrets mtt i millisekunder.
+   * set_time_ms: Stter ny tid p angiven timerkrets mtt i millisekunder,
+   *              angiven som heltal, i fixpunktsformat (q16_16) eller som
+   *              flyttal. Endast flyttal krver flyttalsberkningar. Vid
+   *              lyckad instllning returneras 0. Ifall tiden inte ryms i
+   *              rknaren returneras felkod 1 och tiden lmnas ofrndrad.
    * 
    *               - new_time_ms: Tiden timern ska sttas p i millisekunder.
    ********************************************************************************/
-   void set_time_ms(const double new_time_ms)
+   template<class T>
+   int set_time_ms(const T new_time_ms)
    {
-      this->max_count_ = this->get_max_count(new_time_ms);
-      return;
+      uint32_t fraction;
+      const uint32_t max_count = get_max_count(new_time_ms, fraction);
+      return this->set_period(max_count, fraction);
    }
 
    /********************************************************************************
    * set_max_count: Stter nytt maxvrde fr upprkning av timern nr denna ska
-   *                anvndas som en rknare.
+   *                anvndas som en rknare. Vid lyckad instllning returneras
+   *                0. Ifall maxvrdet inte ryms i rknaren returneras felkod 1
+   *                och maxvrdet lmnas ofrndrat.
    *
    *                - new_max_count: Maxvrde fr upprkningen.
    ********************************************************************************/
-   void set_max_count(const uint32_t new_max_count)
+   int set_max_count(const uint32_t new_max_count)
    {
-      this->max_count_ = new_max_count;
-      return;
+      return this->set_period(new_max_count, 0);
    }
+};
+
+/********************************************************************************
+* on_tick: Rknar upp angiven timer via instansen fr aktuell rknarbredd.
+********************************************************************************/
+inline bool timer_base::on_tick(void)
+{
+   if (this->width_ == 1) return this->as<uint8_t>().on_tick();
+   if (this->width_ == 2) return this->as<uint16_t>().on_tick();
+   return this->as<uint32_t>().on_tick();
+}
+
+/********************************************************************************
+* lateness: Returnerar angiven timers frsening via instansen fr aktuell
+*           rknarbredd.
+********************************************************************************/
+inline int32_t timer_base::lateness(void) const
+{
+   if (this->width_ == 1) return this->as<uint8_t>().lateness();
+   if (this->width_ == 2) return this->as<uint16_t>().lateness();
+   return this->as<uint32_t>().lateness();
+}
+
+/********************************************************************************
+* expire_late: Lter angiven timer lpa ut efter samordning via instansen
+*              fr aktuell rknarbredd.
+********************************************************************************/
+inline void timer_base::expire_late(void)
+{
+   if (this->width_ == 1) this->as<uint8_t>().expire_late();
+   else if (this->width_ == 2) this->as<uint16_t>().expire_late();
+   else this->as<uint32_t>().expire_late();
+   return;
+}
+
+/********************************************************************************
+* reload: Startar om angiven timers period via instansen fr aktuell
+*         rknarbredd.
+********************************************************************************/
+inline void timer_base::reload(void)
+{
+   if (this->width_ == 1) this->as<uint8_t>().reload();
+   else if (this->width_ == 2) this->as<uint16_t>().reload();
+   else this->as<uint32_t>().reload();
+   return;
+}
+
+/********************************************************************************
+* count: Rknar upp angiven timers rknare via instansen fr aktuell
+*        rknarbredd.
+********************************************************************************/
+inline void timer_base::count(void)
+{
+   if (this->width_ == 1) this->as<uint8_t>().count();
+   else if (this->width_ == 2) this->as<uint16_t>().count();
+   else this->as<uint32_t>().count();
+   return;
+}
+
+/********************************************************************************
+* max_count: Returnerar angiven timers maxvrde via instansen fr aktuell
+*            rknarbredd.
+********************************************************************************/
+inline uint32_t timer_base::max_count(void) const
+{
+   if (this->width_ == 1) return this->as<uint8_t>().max_count();
+   if (this->width_ == 2) return this->as<uint16_t>().max_count();
+   return this->as<uint32_t>().max_count();
+}
+
+/* Timer med 32-bitars rknare: */
+typedef basic_timer<uint32_t> timer;
+
+/********************************************************************************
+* select_type: Vljer datatypen T ifall villkoret B r sant, annars F.
+********************************************************************************/
+template<bool B, class T, class F>
+struct select_type
+{
+   typedef T type;
+};
+
+template<class T, class F>
+struct select_type<false, T, F>
+{
+   typedef F type;
+};
+
+/********************************************************************************
+* timer_width: Vljer minsta rknarbredd fr en timer med angiven tid mtt i
+*              millisekunder. Rknaren ska rymma dubbla perioden, s att
+*              extra avbrott samt slack fr plats.
+********************************************************************************/
+template<uint32_t TIME_MS>
+struct timer_width
+{
+   static constexpr uint32_t MAX_COUNT = static_cast<uint32_t>(TIME_MS * 125ULL / 16) + 1;
+   typedef typename select_type<MAX_COUNT <= 0x7F, uint8_t,
+           typename select_type<MAX_COUNT <= 0x7FFF, uint16_t, uint32_t>::type>::type type;
+};
+
+/********************************************************************************
+* timer_for: Klassmall fr timer med minsta rknarbredd fr tiden TIME_MS
+*            mtt i millisekunder, exempelvis timer_for<300>. Perioden
+*            hrleds frn TIME_MS, s att den alltid ryms i rknaren. Ny tid
+*            kan sttas via set_time_ms, som returnerar felkod 1 ifall tiden
+*            inte ryms.
+********************************************************************************/
+template<uint32_t TIME_MS>
+class timer_for : public basic_timer<typename timer_width<TIME_MS>::type>
+{
+   static_assert(TIME_MS >= 1 && TIME_MS <= 32767, "Tiden mste vara mellan 1 - 32 767 ms!");
+public:
 
    /********************************************************************************
-   * sel: Enumeration fr val av timerkrets.
+   * timer_for: Initierar ny timer med tiden TIME_MS. Ifall begrd timerkrets
+   *            r upptagen blir timern en mjukvarutimer.
+   *
+   *            - timer_sel   : Val av timerkrets, alternativt sel::automatic.
+   *            - new_callback: Callbackrutin vid utlpt timer (default = ingen).
    ********************************************************************************/
-   enum class sel
-   {
-      timer0, /* Timer 0. */
-      timer1, /* Timer 1. */
-      timer2, /* Timer 2. */
-      none    /* Timer ospecificerad. */
-   };
+   timer_for(const timer_base::sel timer_sel,
+             const timer_base::callback new_callback = nullptr)
+      : basic_timer<typename timer_width<TIME_MS>::type>(timer_sel, q16_16(static_cast<int32_t>(TIME_MS)),
+                                                         new_callback) { }
 };
 
 #endif /* TIMER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+trace_decode.py: Avkodar binära spårningsramar skickade via trace::dump
+                 (se trace.hpp) och skriver ut dem som en tidslinje.
+
+                 Indata läses från angiven fil, exempelvis en seriell port
+                 som har konfigurerats via stty, eller från stdin:
+
+                 stty -F /dev/ttyACM0 115200 raw
+                 python3 tools/trace_decode.py /dev/ttyACM0
+
+                 Tidsstämplarna är 16 bitar à 0.128 ms och slår därmed runt
+                 var 8.4:e sekund. Runtslag mellan efterföljande poster
+                 hanteras, så att tidslinjen blir monoton så länge tiden
+                 mellan två poster understiger 8.4 sekunder.
+"""
+import struct
+import sys
+
+TICK_MS = 0.128 # Tid per tick i millisekunder.
+
+# Händelsekoder, ska hållas i synk med enumerationen trace::event:
+EVENTS = {
+    0: "none",
+    1: "pcint",
+    2: "button_press",
+    3: "button_release",
+    4: "timer_enable",
+    5: "timer_disable",
+    6: "timer_elapsed",
+    7: "led_on",
+    8: "led_off",
+    9: "adc_complete",
+}
+
+def event_name(code):
+    """
+    event_name: Returnerar namnet på angiven händelsekod.
+    """
+    if code in EVENTS:
+        return EVENTS[code]
+    elif code >= 0x80:
+        return "user+%d" % (code - 0x80)
+    else:
+        return "unknown(%d)" % code
+
+def read_exact(stream, size):
+    """
+    read_exact: Läser exakt angivet antal byte. Returnerar None vid filslut.
+    """
+    data = b""
+    while len(data) < size:
+        chunk = stream.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+def frames(stream):
+    """
+    frames: Genererar (överskrivna poster, poster) för varje ram i strömmen.
+            Bytes före startmarkören hoppas över, exempelvis textutskrifter.
+    """
+    previous = b""
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            return
+        if previous + byte != b"TR":
+            previous = byte
+            continue
+        previous = b""
+        header = read_exact(stream, 3)
+        if header is None:
+            return
+        count, overwritten = struct.unpack("<BH", header)
+        payload = read_exact(stream, 4 * count)
+        if payload is None:
+            return
+        yield overwritten, [struct.unpack_from("<BBH", payload, 4 * i) for i in range(count)]
+
+def render(overwritten, records, out):
+    """
+    render: Skriver ut en ram som tidslinje med tid relativt första posten
+            samt tid sedan föregående post.
+    """
+    out.write("--- %d poster" % len(records))
+    if overwritten:
+        out.write(", %d äldre poster överskrivna eller förlorade" % overwritten)
+    out.write(" ---\n")
+    elapsed = 0
+    previous = None
+    for code, arg, timestamp in records:
+        delta = 0 if previous is None else (timestamp - previous) & 0xFFFF
+        elapsed += delta
+        previous = timestamp
+        out.write("%10.3f ms  %+9.3f ms  %-15s arg=%d\n"
+                  % (elapsed * TICK_MS, delta * TICK_MS, event_name(code), arg))
+
+def main(argv):
+    """
+    main: Avkodar ramar från angiven fil eller stdin tills filslut.
+    """
+    stream = open(argv[1], "rb") if len(argv) > 1 else sys.stdin.buffer
+    try:
+        for overwritten, records in frames(stream):
+            render(overwritten, records, sys.stdout)
+            sys.stdout.flush()
+    finally:
+        if stream is not sys.stdin.buffer:
+            stream.close()
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,248 @@
+/********************************************************************************
+* trace.hpp: Innehller funktionalitet fr sprning av hndelser i RAM via
+*            den statiska klassen trace. Varje hndelse lagras som en post
+*            med fast storlek p fyra byte (hndelsekod, argument samt
+*            tidsstmpel) i en cirkulr buffert, dr ldsta post skrivs ver
+*            nr bufferten r full. Drmed finns alltid de senaste hndelserna
+*            kvar, exempelvis i vilken ordning PCI-avbrott, timeravbrott samt
+*            toggling av lysdioder har skett, utan den overhead som utskrift
+*            av text medfr.
+*
+*            Tidsstmpeln utgrs av den delade ticken i klassen timer, som
+*            rknas upp var 0.128:e millisekund och startas vid anrop av init.
+*            Den delade ticken lper drmed alltid nr sprning r aktiverad,
+*            oavsett ifall timergenererat avbrott via klassen timer r
+*            aktiverat eller inte. Tidsstmpeln lagras med 16 bitar och slr
+*            drmed runt var 8.4:e sekund.
+*
+*            Bufferten skickas binrt via USART0 genom anrop av dump, varefter
+*            sprningen kan avkodas till en tidslinje p vrddatorn via
+*            skriptet tools/trace_decode.py. Varje verfring utgrs av en
+*            ram enligt nedan, dr samtliga tal r little endian:
+*
+*            Byte      Innehll
+*            0 - 1     Startmarkr 'T', 'R'
+*            2         Antal poster N
+*            3 - 4     Antal verskrivna eller frlorade poster sedan
+*                      senaste dump, dr frlorade poster r hndelser
+*                      som intrffade under fregende dump
+*            5 -       N poster, ldsta frst: id, arg, timestamp (2 byte)
+********************************************************************************/
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "serial.hpp"
+#include "timer.hpp"
+
+/********************************************************************************
+* trace: Statisk klass fr sprning av hndelser. Anrop av record tar endast
+*        ngra f klockcykler och kan drmed gras direkt frn avbrotts-
+*        rutiner.
+********************************************************************************/
+class trace
+{
+public:
+   enum class event : uint8_t; /* Frdeklaration av enumerationsklass fr hndelsekoder. */
+   static constexpr uint8_t SIZE = 32; /* Antal poster i bufferten (tvpotens). */
+
+   /********************************************************************************
+   * record_t: Strukt fr en post i bufferten.
+   ********************************************************************************/
+   struct record_t
+   {
+      uint8_t id;         /* Hndelsekod. */
+      uint8_t arg;        /* Argument, exempelvis pin-nummer eller timerkrets. */
+      uint16_t timestamp; /* Tidsstmpel mtt i tickar  0.128 ms. */
+   };
+
+private:
+   static_assert(SIZE >= 2 && SIZE <= 128 && (SIZE & (SIZE - 1)) == 0,
+                 "Bufferten mste rymma en tvpotens mellan 2 - 128 poster!");
+
+   static inline record_t records_[SIZE] = { };  /* Cirkulr buffert med poster. */
+   static inline volatile uint8_t index_ = 0;     /* Index dr nsta post ska skrivas. */
+   static inline volatile uint8_t count_ = 0;     /* Antal lagrade poster. */
+   static inline volatile uint16_t overwritten_ = 0; /* Antal verskrivna eller frlorade poster. */
+   static inline bool enabled_ = false;           /* Indikerar ifall sprning pgr. */
+   static inline volatile bool dumping_ = false;  /* Indikerar ifall sprningen pausats fr dump. */
+
+   /********************************************************************************
+   * send: Placerar en byte i sndningsbufferten fr USART0. Ifall bufferten
+   *       r full vntas tills plats finns, s att byten inte rknas som
+   *       kastad av klassen serial.
+   *
+   *       - data: Byten som ska skickas.
+   ********************************************************************************/
+   static void send(const uint8_t data)
+   {
+      while (serial::free_space() == 0);
+      static_cast<void>(serial::write(data));
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * init: Startar sprning samt den delade ticken, som anvnds som
+   *       tidsstmpel. Vid lyckad start returneras 0. Ifall den delade
+   *       ticken inte kan startas, eftersom Timer 2 r reserverad,
+   *       returneras felkod 1 och sprningen startas inte.
+   ********************************************************************************/
+   static int init(void)
+   {
+      if (timer::start_shared_tick()) return 1;
+      enabled_ = true;
+      return 0;
+   }
+
+   /********************************************************************************
+   * stop: Avslutar sprning. Lagrade poster finns kvar och kan skickas.
+   ********************************************************************************/
+   static void stop(void)
+   {
+      enabled_ = false;
+      return;
+   }
+
+   /********************************************************************************
+   * record: Lagrar en post med angiven hndelsekod och argument samt aktuell
+   *         tidsstmpel. Ifall bufferten r full skrivs ldsta post ver.
+   *         Under pgende dump lagras ingen post, men hndelsen rknas
+   *         som frlorad och rapporteras i nsta dump.
+   *
+   *         - id : Hndelsekod.
+   *         - arg: Argument till hndelsen (default = 0).
+   ********************************************************************************/
+   static void record(const event id,
+                      const uint8_t arg = 0)
+   {
+      if (!enabled_ && !dumping_) return;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+
+      if (dumping_)
+      {
+         overwritten_++;
+         SREG = sreg;
+         return;
+      }
+
+      const uint8_t index = index_;
+      records_[index].id = static_cast<uint8_t>(id);
+      records_[index].arg = arg;
+      records_[index].timestamp = static_cast<uint16_t>(timer::ticks());
+      index_ = (index + 1) & (SIZE - 1);
+
+      if (count_ < SIZE)
+      {
+         count_++;
+      }
+      else
+      {
+         overwritten_++;
+      }
+
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * now: Returnerar aktuell tidsstmpel mtt i tickar  0.128 ms.
+   ********************************************************************************/
+   static uint16_t now(void)
+   {
+      return static_cast<uint16_t>(timer::ticks());
+   }
+
+   /********************************************************************************
+   * count: Returnerar antalet lagrade poster.
+   ********************************************************************************/
+   static uint8_t count(void)
+   {
+      return count_;
+   }
+
+   /********************************************************************************
+   * clear: Tmmer bufferten.
+   ********************************************************************************/
+   static void clear(void)
+   {
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      index_ = 0;
+      count_ = 0;
+      overwritten_ = 0;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * dump: Skickar samtliga lagrade poster binrt via USART0, ldsta frst,
+   *       varefter bufferten tms. Sprningen pausas under verfringen, s
+   *       att skickade poster r konsistenta. Hndelser under verfringen
+   *       rknas som frlorade och rapporteras i nsta dump, s att luckan
+   *       i tidslinjen syns vid avkodning. Ska anropas frn huvudprogrammet
+   *       med avbrott aktiverade, d funktionen vntar p plats i sndnings-
+   *       bufferten. USART0 mste vara initierad via serial::init.
+   ********************************************************************************/
+   static void dump(void)
+   {
+      const bool enabled = enabled_;
+      const uint8_t sreg = SREG;
+      asm("CLI");
+      enabled_ = false;
+      dumping_ = enabled;
+      const uint8_t count = count_;
+      const uint8_t first = (index_ - count) & (SIZE - 1);
+      const uint16_t overwritten = overwritten_;
+      SREG = sreg;
+
+      send('T');
+      send('R');
+      send(count);
+      send(static_cast<uint8_t>(overwritten));
+      send(static_cast<uint8_t>(overwritten >> 8));
+
+      for (uint8_t i = 0; i < count; ++i)
+      {
+         const record_t& record = records_[(first + i) & (SIZE - 1)];
+         send(record.id);
+         send(record.arg);
+         send(static_cast<uint8_t>(record.timestamp));
+         send(static_cast<uint8_t>(record.timestamp >> 8));
+      }
+
+      asm("CLI");
+      index_ = 0;
+      count_ = 0;
+      overwritten_ -= overwritten;
+      dumping_ = false;
+      enabled_ = enabled;
+      SREG = sreg;
+      return;
+   }
+
+   /********************************************************************************
+   * event: Enumeration fr hndelsekoder. Koder frn och med user r fria
+   *        att anvnda fr applikationsspecifika hndelser. Tabellen i
+   *        tools/trace_decode.py ska hllas i synk med denna enumeration.
+   ********************************************************************************/
+   enum class event : uint8_t
+   {
+      none,           /* Ingen hndelse. */
+      pcint,          /* PCI-avbrott, argument = I/O-port (0 = B, 1 = C, 2 = D). */
+      button_press,   /* Tryckknapp nedtryckt, argument = pin p I/O-port. */
+      button_release, /* Tryckknapp uppslppt, argument = pin p I/O-port. */
+      timer_enable,   /* Timeravbrott aktiverat, argument = timerkrets. */
+      timer_disable,  /* Timeravbrott inaktiverat, argument = timerkrets. */
+      timer_elapsed,  /* Timer har lpt ut, argument = timerkrets. */
+      led_on,         /* Lysdiod tnd, argument = pin p I/O-port. */
+      led_off,        /* Lysdiod slckt, argument = pin p I/O-port. */
+      adc_complete,   /* AD-omvandling slutfrd, argument = kanal. */
+      user = 0x80     /* Frsta applikationsspecifika hndelsekod. */
+   };
+};
+
+#endif /* TRACE_HPP_ */
\ No newline at end of file